@@ -35,7 +35,7 @@ typedef uint16_t segment_t;
 
 #else
 //32-bit
-#define D_MK_FP(s,o) (void*)((s<<4)+o)
+#define D_MK_FP(s,o) (void*)(((s)<<4)+(o))
 #define D_FP_SEG(p)  (((uint32_t)p)>>4)
 #define D_FP_OFF(p)  (((uint32_t)p)&15)
 
@@ -45,6 +45,7 @@ typedef uint32_t segment_t;
 
 #define _fmemchr	memchr
 #define _fmemcpy	memcpy
+#define _fmemmove	memmove
 #define _fmemset	memset
 #define _fstrcpy	strcpy
 #define _fstrlen	strlen
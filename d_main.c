@@ -235,6 +235,9 @@ static void TryRunTics (void)
         runtics = maketic - _g_gametic;
         if (runtics <= 0)
         {
+            // use the spare time to load lumps that will be needed soon
+            W_RunReadAhead();
+
             if (I_GetTime() - entertime > 10)
             {
                 M_Ticker();
@@ -454,7 +457,14 @@ void D_StartTitle (void)
 static int myargc;
 static const char * const * myargv;
 
-static int16_t M_CheckParm(char *check)
+// called before Z_Init, so the zone can check parameters too
+void D_SetArgs(int argc, const char * const * argv)
+{
+    myargc = argc;
+    myargv = argv;
+}
+
+int16_t M_CheckParm(char *check)
 {
 	for (int16_t i = 1; i < myargc; i++)
 		if (!stricmp(check, myargv[i]))
@@ -511,6 +521,8 @@ static void D_DoomMainSetup(void)
 
     I_InitGraphics();
 
+    _g_nolvcsave = M_CheckParm("-nolvcsave");
+
     int16_t p = M_CheckParm("-timedemo");
     if (p && p < myargc - 1)
     {
@@ -529,11 +541,8 @@ static void D_DoomMainSetup(void)
 // D_DoomMain
 //
 
-void D_DoomMain(int argc, const char * const * argv)
+void D_DoomMain(void)
 {
-    myargc = argc;
-    myargv = argv;
-
     D_DoomMainSetup(); // CPhipps - setup out of main execution stack
 
     D_DoomLoop ();  // never returns
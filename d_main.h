@@ -60,7 +60,9 @@ void D_AdvanceDemo(void);
 
 void D_PageTicker(void);
 void D_StartTitle(void);
-void D_DoomMain(int argc, const char * const * argv);
+void D_SetArgs(int argc, const char * const * argv);
+int16_t M_CheckParm(char *check);
+void D_DoomMain(void);
 
 
 
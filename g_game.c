@@ -62,6 +62,7 @@
 #include "am_map.h"
 #include "w_wad.h"
 #include "r_main.h"
+#include "r_things.h"
 #include "p_map.h"
 #include "s_sound.h"
 #include "d_englsh.h"
@@ -360,7 +361,7 @@ static void G_DoLoadLevel (void)
     // by Z_FreeTags() when the previous level ended or player
     // died.
 
-    P_SetSecnodeFirstpoolToNull();
+    P_ClearSecnodes();
 
 
     P_SetupLevel (_g_gamemap);
@@ -652,6 +653,9 @@ static void G_DoCompleted (void)
     if (automapmode & am_active)
         AM_Stop();
 
+    // make room for the intermission graphics
+    R_ClearSpriteCache();
+
     if (_g_gamemap == 9) // kilough 2/7/98
         _g_player.didsecret = true;
 
@@ -1122,6 +1126,7 @@ static void G_DoPlayDemo(void)
 
     _g_demoplayback = true;
 
+    _g_sightcachehits = _g_sightcachemisses = 0;
     starttime = I_GetTime();
 }
 
@@ -1137,9 +1142,13 @@ void G_CheckDemoStatus (void)
         // killough -- added fps information and made it work for longer demos:
         uint32_t realtics = endtime - starttime;
         uint32_t resultfps = TICRATE * 1000L * _g_gametic / realtics;
-        I_Error ("Timed %lu gametics in %lu realtics = %lu.%.3lu frames per second",
+        I_Error ("Timed %lu gametics in %lu realtics = %lu.%.3lu frames per second\n"
+                 "Sight cache: %lu hits, %lu misses\n"
+                 "REJECT: %u%% -> %u%% in %ld tics",
                  (uint32_t) _g_gametic,realtics,
-                 resultfps / 1000, resultfps % 1000);
+                 resultfps / 1000, resultfps % 1000,
+                 _g_sightcachehits, _g_sightcachemisses,
+                 _g_rejectbefore, _g_rejectafter, _g_rejecttics);
     }
 
     Z_ChangeTagToCache(demobuffer);
@@ -144,6 +144,12 @@ extern divline_t _g_trace;
 // Store VERTEXES, LINEDEFS, SIDEDEFS, etc.
 //
 
+extern uint16_t _g_rejectbefore;   // REJECT ratio in %, before and after
+extern uint16_t _g_rejectafter;    // P_BuildReject, for the last map
+extern int32_t  _g_rejecttics;
+
+extern boolean _g_nolvcsave;      // don't write level cache files
+
 extern int16_t      _g_numvertexes;
 extern const vertex_t __far* _g_vertexes;
 
@@ -197,8 +203,12 @@ extern mobj_t    __far*__far* _g_blocklinks;           // for thing chains
 extern const byte __far* _g_rejectmatrix;
 
 
-extern mobj_t __far*      _g_thingPool;
-extern int16_t _g_thingPoolSize;
+//******************************************************************************
+//p_sight.c
+//******************************************************************************
+
+extern uint32_t _g_sightcachehits;
+extern uint32_t _g_sightcachemisses;
 
 
 //******************************************************************************
@@ -216,7 +226,7 @@ extern int32_t _g_leveltime; // tics in game play for par
 
 // killough 8/29/98: we maintain several separate threads, each containing
 // a special class of thinkers, to allow more efficient searches.
-extern thinker_t _g_thinkerclasscap;
+extern thinker_t _g_thinkerclasscap[NUMTHCLASSES];
 
 
 //******************************************************************************
@@ -106,12 +106,15 @@ int main(int argc, const char * const * argv)
 	//Call this before Z_Init as maxmod uses malloc.
 	I_Init();
 
+	D_SetArgs(argc, argv);
+
+	// the expanded memory lump cache costs the zone a page, so it's opt-in
 	printf("Z_Init: Init zone memory allocation daemon.\n");
-	Z_Init();                  /* 1/18/98 killough: start up memory stuff first */
+	Z_Init(M_CheckParm("-emscache"));                  /* 1/18/98 killough: start up memory stuff first */
 
 	//InitGlobals
 	freehead = &_g_freetail;
 
-	D_DoomMain(argc, argv);
+	D_DoomMain();
 	return 0;
 }
@@ -191,6 +191,21 @@ uint8_t  __far* _g_screen;
 
 static int8_t newpal;
 
+
+typedef struct
+{
+	int16_t x;
+	int16_t y;
+	int16_t width;
+	int16_t height;
+} statusbarrect_t;
+
+#define MAXSTATUSBARRECTS	20
+#define STATUSBAR_FULL		-1
+
+static statusbarrect_t statusbarrects[MAXSTATUSBARRECTS];
+static int8_t numstatusbarrects = STATUSBAR_FULL;
+
 uint8_t __far* I_GetBackBuffer(void)
 {
 	return backBuffer;
@@ -239,6 +254,23 @@ static void I_UploadNewPalette(int8_t pal)
 }
 
 
+//
+// I_CopyRect
+// Copies a rectangle of a buffer to the same place on the screen.
+//
+static void I_CopyRect(const uint8_t __far* buffer, int16_t x, int16_t y, int16_t width, int16_t height)
+{
+	const uint8_t __far* src = buffer + y * SCREENWIDTH     + x;
+	uint8_t __far*       dst = screen + y * SCREENWIDTH_VGA + x;
+
+	for (int16_t i = 0; i < height; i++) {
+		_fmemcpy(dst, src, width);
+		dst += SCREENWIDTH_VGA;
+		src += SCREENWIDTH;
+	}
+}
+
+
 //
 // I_FinishUpdate
 //
@@ -253,7 +285,55 @@ void I_FinishUpdate (void)
 		newpal = NO_PALETTE_CHANGE;
 	}
 
+#if defined DISABLE_STATUS_BAR
 	I_DrawBuffer(backBuffer);
+#else
+	if (numstatusbarrects == STATUSBAR_FULL)
+	{
+		I_DrawBuffer(backBuffer);
+		return;
+	}
+
+	I_CopyRect(backBuffer, 0, 0, SCREENWIDTH, SCREENHEIGHT - ST_HEIGHT);
+
+	// only the widgets that changed
+	for (int8_t i = 0; i < numstatusbarrects; i++)
+	{
+		const statusbarrect_t* r = &statusbarrects[i];
+		I_CopyRect(backBuffer, r->x, r->y, r->width, r->height);
+	}
+#endif
+}
+
+
+//
+// I_ClearStatusBarRects
+//
+// Nothing in the status bar has changed this frame,
+// except for the rectangles added by I_AddStatusBarRect
+//
+void I_ClearStatusBarRects(void)
+{
+	numstatusbarrects = 0;
+}
+
+
+void I_AddStatusBarRect(int16_t x, int16_t y, int16_t width, int16_t height)
+{
+	if (numstatusbarrects == STATUSBAR_FULL)
+		return;
+
+	if (numstatusbarrects == MAXSTATUSBARRECTS)
+	{
+		numstatusbarrects = STATUSBAR_FULL;
+		return;
+	}
+
+	statusbarrect_t* r = &statusbarrects[numstatusbarrects++];
+	r->x      = x;
+	r->y      = y;
+	r->width  = width;
+	r->height = height;
 }
 
 
@@ -283,23 +363,17 @@ void I_InitGraphics(void)
 void I_StartDisplay(void)
 {
 	_g_screen = backBuffer;
+	numstatusbarrects = STATUSBAR_FULL;
 }
 
 
 void I_DrawBuffer(uint8_t __far* buffer)
 {
-	uint8_t __far* src = buffer;
-	uint8_t __far* dst = screen;
-
 #if defined DISABLE_STATUS_BAR
-	for (uint_fast8_t y = 0; y < SCREENHEIGHT - ST_HEIGHT; y++) {
+	I_CopyRect(buffer, 0, 0, SCREENWIDTH, SCREENHEIGHT - ST_HEIGHT);
 #else
-	for (uint_fast8_t y = 0; y < SCREENHEIGHT; y++) {
+	I_CopyRect(buffer, 0, 0, SCREENWIDTH, SCREENHEIGHT);
 #endif
-		_fmemcpy(dst, src, SCREENWIDTH);
-		dst += SCREENWIDTH_VGA;
-		src += SCREENWIDTH;
-	}
 }
 
 
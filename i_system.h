@@ -52,6 +52,11 @@ void I_InitGraphics();
 void I_FinishUpdate(void);
 void I_DrawBuffer(uint8_t __far* buffer);
 
+// Status bar rows are blitted in full, unless the status bar
+// clears the rectangle list and reports its changed widgets.
+void I_ClearStatusBarRects(void);
+void I_AddStatusBarRect(int16_t x, int16_t y, int16_t width, int16_t height);
+
 void I_SetPalette(int8_t pal);
 
 /* I_StartTic
@@ -287,7 +287,7 @@ boolean EV_DoCeiling(const line_t __far* line, ceiling_e type)
 
     // create a new ceiling thinker
     rtn = true;
-    ceiling = Z_CallocLevSpec(sizeof(*ceiling));
+    ceiling = P_CallocThinker(TP_MOVER);
     P_AddThinker (&ceiling->thinker);
     sec->ceilingdata = ceiling;               //jff 2/22/98
     ceiling->thinker.function = T_MoveCeiling;
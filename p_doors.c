@@ -68,13 +68,13 @@ static void EV_LightTurnOnPartway(const line_t __far* line, fixed_t level)
   // search all sectors for ones with same tag as activating line
   for (i = -1; (i = P_FindSectorFromLineTag(line,i)) >= 0;)
     {
-      sector_t __far* temp;
+      const sector_t __far* temp;
       sector_t __far* sector = _g_sectors+i;
       int16_t j, bright = 0, min = sector->lightlevel;
 
-      for (j = 0; j < sector->linecount; j++)
-  if ((temp = getNextSector(sector->lines[j],sector)))
+      for (j = 0; j < sector->neighbourcount; j++)
     {
+      temp = &_g_sectors[sector->neighbours[j]];
       if (temp->lightlevel > bright)
         bright = temp->lightlevel;
       if (temp->lightlevel < min)
@@ -341,7 +341,7 @@ boolean EV_DoDoor(const line_t __far* line, vldoor_e type)
 
     // new door thinker
     rtn = true;
-    door = Z_CallocLevSpec(sizeof(*door));
+    door = P_CallocThinker(TP_MOVER);
     P_AddThinker (&door->thinker);
     sec->ceilingdata = door; //jff 2/22/98
 
@@ -422,7 +422,7 @@ void P_SpawnDoorCloseIn30(sector_t __far* sec)
 {
   vldoor_t __far* door;
 
-  door = Z_CallocLevSpec(sizeof(*door));
+  door = P_CallocThinker(TP_MOVER);
 
   P_AddThinker (&door->thinker);
 
@@ -451,7 +451,7 @@ void P_SpawnDoorRaiseIn5Mins(sector_t __far* sec)
 {
   vldoor_t __far* door;
 
-  door = Z_CallocLevSpec(sizeof(*door));
+  door = P_CallocThinker(TP_MOVER);
 
   P_AddThinker (&door->thinker);
 
@@ -961,7 +961,7 @@ void A_BossDeath(mobj_t __far* mo)
 
     // scan the remaining thinkers to see
     // if all bosses are dead
-    for (th = _g_thinkerclasscap.next; th != &_g_thinkerclasscap; th = th->next)
+    for (th = _g_thinkerclasscap[TH_MAIN].next; th != &_g_thinkerclasscap[TH_MAIN]; th = th->next)
         if (th->function == P_MobjThinker)
         {
             mobj_t __far* mo2 = (mobj_t __far*) th;
@@ -185,6 +185,9 @@ static boolean P_CheckSector(sector_t __far* sector, boolean crunch)
   nofit = false;
   crushchange = crunch;
 
+  // a plane moved, so cached sight checks may be wrong
+  P_ClearSightCache();
+
   // killough 4/4/98: scan list front-to-back until empty or exhausted,
   // restarting from beginning after each thing is processed. Avoids
   // crashes, and is sure to examine all things in the sector, and only
@@ -475,17 +478,6 @@ void T_MoveFloor(floormove_t __far* floor)
 // jff 02/22/98 added to support parallel floor/ceiling motion
 //
 
-typedef struct
-{
-  thinker_t thinker;
-  elevator_e type;
-  sector_t __far* sector;
-  int16_t direction;
-  fixed_t floordestheight;
-  fixed_t ceilingdestheight;
-  fixed_t speed;
-} elevator_t;
-
 static void T_MoveElevator(elevator_t __far* elevator)
 {
   result_e      res;
@@ -564,17 +556,15 @@ static void T_MoveElevator(elevator_t __far* elevator)
 fixed_t P_FindNextHighestFloor(sector_t __far* sec)
 {
   fixed_t currentheight = sec->floorheight;
-  sector_t __far* other;
+  const sector_t __far* other;
   int16_t i;
 
-  for (i=0 ;i < sec->linecount ; i++)
-    if ((other = getNextSector(sec->lines[i],sec)) &&
-         other->floorheight > currentheight)
+  for (i=0 ;i < sec->neighbourcount ; i++)
+    if ((other = &_g_sectors[sec->neighbours[i]])->floorheight > currentheight)
     {
       fixed_t height = other->floorheight;
-      while (++i < sec->linecount)
-        if ((other = getNextSector(sec->lines[i],sec)) &&
-            other->floorheight < height &&
+      while (++i < sec->neighbourcount)
+        if ((other = &_g_sectors[sec->neighbours[i]])->floorheight < height &&
             other->floorheight > currentheight)
           height = other->floorheight;
       return height;
@@ -622,7 +612,7 @@ boolean EV_DoFloor(const line_t __far* line, floor_e floortype)
 
     // new floor thinker
     rtn = true;
-    floor = Z_CallocLevSpec(sizeof(*floor));
+    floor = P_CallocThinker(TP_MOVER);
     P_AddThinker (&floor->thinker);
     sec->floordata = floor; //jff 2/22/98
     floor->thinker.function = T_MoveFloor;
@@ -914,7 +904,7 @@ boolean EV_BuildStairs(const line_t __far* line, stair_e type)
 
     // create new floor thinker for first step
     rtn = true;
-    floor = Z_CallocLevSpec(sizeof(*floor));
+    floor = P_CallocThinker(TP_MOVER);
     P_AddThinker (&floor->thinker);
     sec->floordata = floor;
     floor->thinker.function = T_MoveFloor;
@@ -982,7 +972,7 @@ boolean EV_BuildStairs(const line_t __far* line, stair_e type)
         secnum = newsecnum;
 
         // create and initialize a thinker for the next step
-        floor = Z_CallocLevSpec(sizeof(*floor));
+        floor = P_CallocThinker(TP_MOVER);
         P_AddThinker (&floor->thinker);
 
         sec->floordata = floor; //jff 2/22/98
@@ -1056,7 +1046,7 @@ boolean EV_DoDonut(const line_t __far* line)
       s3 = LN_BACKSECTOR((s2->lines[i]));      // s3 is model sector for changes
 
       //  Spawn rising slime
-      floor = Z_CallocLevSpec(sizeof(*floor));
+      floor = P_CallocThinker(TP_MOVER);
       P_AddThinker (&floor->thinker);
       s2->floordata = floor; //jff 2/22/98
       floor->thinker.function = T_MoveFloor;
@@ -1070,7 +1060,7 @@ boolean EV_DoDonut(const line_t __far* line)
       floor->floordestheight = s3->floorheight;
 
       //  Spawn lowering donut-hole pillar
-      floor = Z_CallocLevSpec(sizeof(*floor));
+      floor = P_CallocThinker(TP_MOVER);
       P_AddThinker (&floor->thinker);
       s1->floordata = floor; //jff 2/22/98
       floor->thinker.function = T_MoveFloor;
@@ -1115,7 +1105,7 @@ boolean EV_DoElevator(const line_t __far* line, elevator_e elevtype)
 
     // create and initialize new elevator thinker
     rtn = true;
-    elevator = Z_CallocLevSpec(sizeof(*elevator));
+    elevator = P_CallocThinker(TP_MOVER);
     P_AddThinker (&elevator->thinker);
     sec->floordata = elevator; //jff 2/22/98
     sec->ceilingdata = elevator; //jff 2/22/98
@@ -310,7 +310,7 @@ manual_floor:
 
     // new floor thinker
     rtn = true;
-    floor = Z_CallocLevSpec(sizeof(*floor));
+    floor = P_CallocThinker(TP_MOVER);
     P_AddThinker (&floor->thinker);
     sec->floordata = floor;
     floor->thinker.function = T_MoveFloor;
@@ -496,17 +496,15 @@ static int16_t P_FindShortestUpperAround(int16_t secnum)
 static fixed_t P_FindNextLowestCeiling(sector_t __far* sec)
 {
   fixed_t currentheight = sec->ceilingheight;
-  sector_t __far* other;
+  const sector_t __far* other;
   int16_t i;
 
-  for (i=0 ;i < sec->linecount ; i++)
-    if ((other = getNextSector(sec->lines[i],sec)) &&
-        other->ceilingheight < currentheight)
+  for (i=0 ;i < sec->neighbourcount ; i++)
+    if ((other = &_g_sectors[sec->neighbours[i]])->ceilingheight < currentheight)
     {
       fixed_t height = other->ceilingheight;
-      while (++i < sec->linecount)
-        if ((other = getNextSector(sec->lines[i],sec)) &&
-            other->ceilingheight > height &&
+      while (++i < sec->neighbourcount)
+        if ((other = &_g_sectors[sec->neighbours[i]])->ceilingheight > height &&
             other->ceilingheight < currentheight)
           height = other->ceilingheight;
       return height;
@@ -528,17 +526,15 @@ static fixed_t P_FindNextLowestCeiling(sector_t __far* sec)
 static fixed_t P_FindNextHighestCeiling(sector_t __far* sec)
 {
   fixed_t currentheight = sec->ceilingheight;
-  sector_t __far* other;
+  const sector_t __far* other;
   int16_t i;
 
-  for (i=0 ;i < sec->linecount ; i++)
-    if ((other = getNextSector(sec->lines[i],sec)) &&
-         other->ceilingheight > currentheight)
+  for (i=0 ;i < sec->neighbourcount ; i++)
+    if ((other = &_g_sectors[sec->neighbours[i]])->ceilingheight > currentheight)
     {
       fixed_t height = other->ceilingheight;
-      while (++i < sec->linecount)
-        if ((other = getNextSector(sec->lines[i],sec)) &&
-            other->ceilingheight < height &&
+      while (++i < sec->neighbourcount)
+        if ((other = &_g_sectors[sec->neighbours[i]])->ceilingheight < height &&
             other->ceilingheight > currentheight)
           height = other->ceilingheight;
       return height;
@@ -634,7 +630,7 @@ manual_ceiling:
 
     // new ceiling thinker
     rtn = true;
-    ceiling = Z_CallocLevSpec(sizeof(*ceiling));
+    ceiling = P_CallocThinker(TP_MOVER);
     P_AddThinker (&ceiling->thinker);
     sec->ceilingdata = ceiling; //jff 2/22/98
     ceiling->thinker.function = T_MoveCeiling;
@@ -850,7 +846,7 @@ manual_lift:
 
     // Setup the plat thinker
     rtn = true;
-    plat = Z_CallocLevSpec(sizeof(*plat));
+    plat = P_CallocThinker(TP_MOVER);
     P_AddThinker(&plat->thinker);
 
     plat->sector = sec;
@@ -1009,7 +1005,7 @@ manual_stair:
 
     // new floor thinker
     rtn = true;
-    floor = Z_CallocLevSpec(sizeof(*floor));
+    floor = P_CallocThinker(TP_MOVER);
     P_AddThinker (&floor->thinker);
     sec->floordata = floor;
     floor->thinker.function = T_MoveFloor;
@@ -1094,7 +1090,7 @@ manual_stair:
 
         sec = tsec;
         secnum = newsecnum;
-        floor = Z_CallocLevSpec(sizeof(*floor));
+        floor = P_CallocThinker(TP_MOVER);
 
         P_AddThinker (&floor->thinker);
 
@@ -1177,7 +1173,7 @@ manual_crusher:
 
     // new ceiling thinker
     rtn = true;
-    ceiling = Z_CallocLevSpec(sizeof(*ceiling));
+    ceiling = P_CallocThinker(TP_MOVER);
     P_AddThinker (&ceiling->thinker);
     sec->ceilingdata = ceiling; //jff 2/22/98
     ceiling->thinker.function = T_MoveCeiling;
@@ -1272,7 +1268,7 @@ manual_locked:
 
     // new door thinker
     rtn = true;
-    door = Z_CallocLevSpec(sizeof(*door));
+    door = P_CallocThinker(TP_MOVER);
     P_AddThinker (&door->thinker);
     sec->ceilingdata = door; //jff 2/22/98
 
@@ -1391,7 +1387,7 @@ manual_door:
 
     // new door thinker
     rtn = true;
-    door = Z_CallocLevSpec(sizeof(*door));
+    door = P_CallocThinker(TP_MOVER);
     P_AddThinker (&door->thinker);
     sec->ceilingdata = door; //jff 2/22/98
 
@@ -59,16 +59,6 @@
 // Returns nothing
 //
 
-typedef struct
-{
-  thinker_t thinker;
-  sector_t __far* sector;
-  int16_t count;
-  int16_t maxlight;
-  int16_t minlight;
-
-} fireflicker_t;
-
 static void T_FireFlicker (fireflicker_t __far* flick)
 {
   int16_t amount;
@@ -95,18 +85,6 @@ static void T_FireFlicker (fireflicker_t __far* flick)
 // Returns nothing
 //
 
-typedef struct
-{
-  thinker_t thinker;
-  sector_t __far* sector;
-  int16_t count;
-  int16_t maxlight;
-  int16_t minlight;
-  int16_t maxtime;
-  int16_t mintime;
-
-} lightflash_t;
-
 static void T_LightFlash (lightflash_t __far* flash)
 {
   if (--flash->count)
@@ -134,18 +112,6 @@ static void T_LightFlash (lightflash_t __far* flash)
 // Returns nothing
 //
 
-typedef struct
-{
-  thinker_t thinker;
-  sector_t __far* sector;
-  int16_t count;
-  int16_t minlight;
-  int16_t maxlight;
-  int16_t darktime;
-  int16_t brighttime;
-
-} strobe_t;
-
 static void T_StrobeFlash (strobe_t __far*   flash)
 {
   if (--flash->count)
@@ -172,15 +138,6 @@ static void T_StrobeFlash (strobe_t __far*   flash)
 // Returns nothing
 //
 
-typedef struct
-{
-  thinker_t thinker;
-  sector_t __far* sector;
-  int16_t minlight;
-  int16_t maxlight;
-  int16_t direction;
-} glow_t;
-
 static void T_Glow(glow_t __far* g)
 {
   switch(g->direction)
@@ -219,17 +176,12 @@ static int16_t P_FindMinSurroundingLight(sector_t __far* sector, int16_t max)
 {
   int16_t         i;
   int16_t         min;
-  const line_t __far*     line;
-  sector_t __far*   check;
+  const sector_t __far*   check;
 
   min = max;
-  for (i=0 ; i < sector->linecount ; i++)
+  for (i=0 ; i < sector->neighbourcount ; i++)
   {
-    line = sector->lines[i];
-    check = getNextSector(line,sector);
-
-    if (!check)
-      continue;
+    check = &_g_sectors[sector->neighbours[i]];
 
     if (check->lightlevel < min)
       min = check->lightlevel;
@@ -263,7 +215,7 @@ void P_SpawnFireFlicker(sector_t __far* sector)
   // Nothing special about it during gameplay.
   sector->special &= ~31; //jff 3/14/98 clear non-generalized sector type
 
-  flick = Z_CallocLevSpec( sizeof(*flick));
+  flick = P_CallocThinker(TP_FIREFLICKER);
 
   P_AddThinker (&flick->thinker);
 
@@ -289,7 +241,7 @@ void P_SpawnLightFlash (sector_t __far* sector)
   // nothing special about it during gameplay
   sector->special &= ~31; //jff 3/14/98 clear non-generalized sector type
 
-  flash = Z_CallocLevSpec(sizeof(*flash));
+  flash = P_CallocThinker(TP_LIGHTFLASH);
 
   P_AddThinker (&flash->thinker);
 
@@ -317,7 +269,7 @@ void P_SpawnStrobeFlash(sector_t __far* sector, int16_t fastOrSlow, boolean inSy
 {
   strobe_t __far* flash;
 
-  flash = Z_CallocLevSpec(sizeof(*flash));
+  flash = P_CallocThinker(TP_STROBE);
 
   P_AddThinker (&flash->thinker);
 
@@ -352,7 +304,7 @@ void P_SpawnGlowingLight(sector_t __far* sector)
 {
   glow_t __far* g;
 
-  g = Z_CallocLevSpec(sizeof(*g));
+  g = P_CallocThinker(TP_GLOW);
 
   P_AddThinker(&g->thinker);
 
@@ -413,12 +365,11 @@ void EV_TurnTagLightsOff(const line_t __far* line)
   for (j = -1; (j = P_FindSectorFromLineTag(line,j)) >= 0;)
     {
       sector_t __far* sector = _g_sectors + j;
-      sector_t __far* tsec;
+      const sector_t __far* tsec;
       int16_t i, min = sector->lightlevel;
       // find min neighbor light level
-      for (i = 0;i < sector->linecount; i++)
-  if ((tsec = getNextSector(sector->lines[i], sector)) &&
-      tsec->lightlevel < min)
+      for (i = 0;i < sector->neighbourcount; i++)
+  if ((tsec = &_g_sectors[sector->neighbours[i]])->lightlevel < min)
     min = tsec->lightlevel;
       sector->lightlevel = min;
     }
@@ -440,15 +391,15 @@ void EV_LightTurnOn(const line_t __far* line, int16_t bright)
 
 	for (i = -1; (i = P_FindSectorFromLineTag(line,i)) >= 0;)
 	{
-		sector_t __far* temp;
+		const sector_t __far* temp;
 		sector_t __far* sector = _g_sectors+i;
 		int16_t j, tbright = bright; //jff 5/17/98 search for maximum PER sector
 
 		// bright = 0 means to search for highest light level surrounding sector
 
 		if (!bright)
-			for (j = 0;j < sector->linecount; j++)
-				if ((temp = getNextSector(sector->lines[j],sector)) && temp->lightlevel > tbright)
+			for (j = 0;j < sector->neighbourcount; j++)
+				if ((temp = &_g_sectors[sector->neighbours[j]])->lightlevel > tbright)
 					tbright = temp->lightlevel;
 
 		sector->lightlevel = tbright;
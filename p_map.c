@@ -561,23 +561,6 @@ boolean P_CheckPosition(mobj_t __far* thing, fixed_t x, fixed_t y)
   }
 
 
-// killough 4/16/98: Same thing, only for linedefs
-
-static int16_t P_FindLineFromLineTag(const line_t __far* line, int16_t start)
-{
-
-    int16_t	i;
-
-    for (i=start+1; i<_g_numlines; i++)
-    {
-        if (_g_lines[i].tag == line->tag)
-            return i;
-    }
-
-    return -1;
-}
-
-
 //
 // Silent linedef-based TELEPORTATION, by Lee Killough
 // Primarily for rooms-over-rooms etc.
@@ -2294,9 +2277,9 @@ void P_RadiusAttack(mobj_t __far* spot, mobj_t __far* source, int16_t damage)
 
 static struct block_memory_alloc_s secnodezone = { NULL, sizeof(msecnode_t), 32 };
 
-void P_SetSecnodeFirstpoolToNull(void)
+void P_ClearSecnodes(void)
 {
-	secnodezone.firstpool = NULL;
+	secnodezone.freelist = NULL;
 }
 
 
@@ -2463,6 +2446,26 @@ static boolean PIT_GetSectors(const line_t __far* ld)
   }
 
 
+//
+// P_BlocksHaveLines
+// Returns true if any of the mapblocks has lines in it.
+//
+
+static boolean P_BlocksHaveLines(int16_t xl, int16_t xh, int16_t yl, int16_t yh)
+{
+  for (int16_t bx = xl; bx <= xh; bx++)
+    for (int16_t by = yl; by <= yh; by++)
+      if (0 <= bx && bx < _g_bmapwidth && 0 <= by && by < _g_bmapheight)
+      {
+        // skip the 0 starting delimiter
+        if (_g_blockmaplump[_g_blockmap[by*_g_bmapwidth+bx] + 1] != -1)
+          return true;
+      }
+
+  return false;
+}
+
+
 // phares 3/14/98
 //
 // P_CreateSecNodeList alters/creates the sector_list that shows what sectors
@@ -2472,18 +2475,6 @@ void P_CreateSecNodeList(mobj_t __far* thing)
 {
   mobj_t __far* saved_tmthing = tmthing; /* cph - see comment at func end */
 
-  // First, clear out the existing m_thing fields. As each node is
-  // added or verified as needed, m_thing will be set properly. When
-  // finished, delete all nodes where m_thing is still NULL. These
-  // represent the sectors the Thing has vacated.
-
-  msecnode_t __far* node = _g_sector_list;
-  while (node)
-    {
-    node->m_thing = NULL;
-    node = node->m_tnext;
-    }
-
   tmthing = thing;
 
   tmx = thing->x;
@@ -2501,6 +2492,30 @@ void P_CreateSecNodeList(mobj_t __far* thing)
   int16_t yl = (_g_tmbbox[BOXBOTTOM] - _g_bmaporgy) >> MAPBLOCKSHIFT;
   int16_t yh = (_g_tmbbox[BOXTOP]    - _g_bmaporgy) >> MAPBLOCKSHIFT;
 
+  // Most moves stay inside the one sector the thing was already in.
+  // If no mapblock under it has lines, it can't touch another sector,
+  // and there's nothing to change.
+
+  msecnode_t __far* node = _g_sector_list;
+  if (node && !node->m_tnext && node->m_sector == thing->subsector->sector
+      && !P_BlocksHaveLines(xl, xh, yl, yh))
+  {
+    node->m_thing = thing;
+    tmthing = saved_tmthing;
+    return;
+  }
+
+  // First, clear out the existing m_thing fields. As each node is
+  // added or verified as needed, m_thing will be set properly. When
+  // finished, delete all nodes where m_thing is still NULL. These
+  // represent the sectors the Thing has vacated.
+
+  while (node)
+    {
+    node->m_thing = NULL;
+    node = node->m_tnext;
+    }
+
   for (int16_t bx = xl; bx <= xh; bx++)
     for (int16_t by = yl; by <= yh; by++)
       P_BlockLinesIterator(bx,by,PIT_GetSectors);
@@ -51,6 +51,7 @@ boolean P_TryMove(mobj_t __far* thing, fixed_t x, fixed_t y);
 // killough 8/9/98: extra argument for telefragging
 boolean P_TeleportMove(mobj_t __far* thing, fixed_t x, fixed_t y, boolean boss);
 boolean P_CheckSight(mobj_t __far* t1, mobj_t __far* t2);
+void    P_ClearSightCache(void);
 void    P_UseLines(player_t *player);
 
 fixed_t P_AimLineAttack(mobj_t __far*t1, angle_t angle, fixed_t distance, boolean friend);
@@ -60,7 +61,7 @@ void    P_RadiusAttack(mobj_t __far* spot, mobj_t __far* source, int16_t damage)
 boolean P_CheckPosition(mobj_t __far* thing, fixed_t x, fixed_t y);
 
 
-void    P_SetSecnodeFirstpoolToNull(void);
+void    P_ClearSecnodes(void);
 void    P_DelSeclist(void);
 void    P_CreateSecNodeList(mobj_t __far*);
 
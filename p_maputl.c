@@ -36,6 +36,9 @@
  *
  *-----------------------------------------------------------------------------*/
 
+#include <stdint.h>
+
+#include "compiler.h"
 #include "d_player.h"
 #include "r_main.h"
 #include "p_maputl.h"
@@ -60,6 +63,120 @@ static intercept_t intercepts[MAXINTERCEPTS];
 static intercept_t* intercept_p;
 
 
+//
+// Trace batches
+// The pellets of a shotgun blast share their origin and stay inside a
+// narrow cone. The first pellet to test a line also tests it against
+// both edges of the cone. A line that lies well clear of the cone,
+// on one side, can't be crossed by any pellet, so the others skip it.
+//
+
+// widen the cone to cover rounding in the pellet directions
+#define TRACEBATCHMARGIN (1 << 22)
+// distance from an edge, in map units scaled by the edge vectors
+#define TRACEBATCHCLEAR  (2 * (FRACUNIT >> 4))
+
+#define TB_CHECKED 1
+#define TB_CLEAR   2
+
+typedef struct {
+  fixed_t x, y;                 // origin of every trace in the batch
+  fixed_t lox, loy, hix, hiy;   // edges of the cone, clockwise first
+  byte __far* lines;            // TB_* flags, two bits per line
+  boolean active;               // between P_BeginTraceBatch and P_EndTraceBatch
+  boolean inuse;                // the current trace is part of the batch
+} tracebatch_t;
+
+static tracebatch_t tracebatch;
+
+
+//
+// P_InitTraceBatch
+// Called at level setup, after the linedefs have been loaded.
+//
+void P_InitTraceBatch(void)
+{
+  tracebatch.lines  = Z_MallocLevel((_g_numlines + 3) / 4, NULL);
+  tracebatch.active = false;
+}
+
+
+void P_BeginTraceBatch(const mobj_t __far* t1, angle_t angle, angle_t spread)
+{
+  _fmemset(tracebatch.lines, 0, (_g_numlines + 3) / 4);
+  tracebatch.active = true;
+
+  // same nudge as P_PathTraverse
+  tracebatch.x = t1->x;
+  if (!((tracebatch.x-_g_bmaporgx)&(MAPBLOCKSIZE-1)))
+    tracebatch.x += FRACUNIT;
+
+  tracebatch.y = t1->y;
+  if (!((tracebatch.y-_g_bmaporgy)&(MAPBLOCKSIZE-1)))
+    tracebatch.y += FRACUNIT;
+
+  int16_t lo = (angle - spread - TRACEBATCHMARGIN) >> ANGLETOFINESHIFT;
+  int16_t hi = (angle + spread + TRACEBATCHMARGIN) >> ANGLETOFINESHIFT;
+  tracebatch.lox = finecosine(lo) >> 4;
+  tracebatch.loy = finesine(  lo) >> 4;
+  tracebatch.hix = finecosine(hi) >> 4;
+  tracebatch.hiy = finesine(  hi) >> 4;
+}
+
+
+void P_EndTraceBatch(void)
+{
+  tracebatch.active = false;
+}
+
+
+static boolean P_InTraceBatch(fixed_t x, fixed_t y, fixed_t dx, fixed_t dy)
+{
+  if (!tracebatch.active || x != tracebatch.x || y != tracebatch.y)
+    return false;
+
+  dx >>= FRACBITS;
+  dy >>= FRACBITS;
+  return tracebatch.lox * dy - tracebatch.loy * dx > 0
+      && tracebatch.hiy * dx - tracebatch.hix * dy > 0;
+}
+
+
+// Returns 1 or -1 if the point is clear of both edges on the same side
+static int16_t P_TraceBatchSide(const vertex_t __far* v)
+{
+  fixed_t x = (v->x - tracebatch.x) >> FRACBITS;
+  fixed_t y = (v->y - tracebatch.y) >> FRACBITS;
+  fixed_t lo = tracebatch.lox * y - tracebatch.loy * x;
+  fixed_t hi = tracebatch.hix * y - tracebatch.hiy * x;
+
+  if (lo > TRACEBATCHCLEAR && hi > TRACEBATCHCLEAR)
+    return 1;
+  else if (lo < -TRACEBATCHCLEAR && hi < -TRACEBATCHCLEAR)
+    return -1;
+  else
+    return 0;
+}
+
+
+static boolean P_IsClearOfTraceBatch(const line_t __far* ld)
+{
+  byte __far* flags = &tracebatch.lines[ld->lineno >> 2];
+  int16_t shift = (ld->lineno & 3) * 2;
+
+  if (!(*flags & (TB_CHECKED << shift)))
+  {
+    int16_t side = P_TraceBatchSide(&ld->v1);
+
+    *flags |= TB_CHECKED << shift;
+    if (side && side == P_TraceBatchSide(&ld->v2))
+      *flags |= TB_CLEAR << shift;
+  }
+
+  return *flags & (TB_CLEAR << shift);
+}
+
+
 //
 // P_AproxDistance
 // Gives an estimation of distance (not exact)
@@ -450,6 +567,24 @@ static boolean check_intercept(void)
     return (offset < MAXINTERCEPTS);
 }
 
+// Makes room for an intercept at frac, keeping the list sorted.
+// Intercepts at the same frac stay in the order they were found.
+static intercept_t* P_InsertIntercept(fixed_t frac)
+{
+  if (!check_intercept())
+    return NULL;
+
+  intercept_t* in = intercept_p++;
+  while (in > intercepts && in[-1].frac > frac)
+  {
+    *in = in[-1];
+    in--;
+  }
+
+  in->frac = frac;
+  return in;
+}
+
 
 // PIT_AddLineIntercepts.
 // Looks for lines in the given block
@@ -468,6 +603,9 @@ static boolean PIT_AddLineIntercepts(const line_t __far* ld)
   fixed_t   frac;
   divline_t dl;
 
+  if (tracebatch.inuse && P_IsClearOfTraceBatch(ld))
+    return true;        // no trace in the batch crosses it
+
   // avoid precision problems with two routines
   if (_g_trace.dx >  FRACUNIT*16 || _g_trace.dy >  FRACUNIT*16 ||
       _g_trace.dx < -FRACUNIT*16 || _g_trace.dy < -FRACUNIT*16)
@@ -491,13 +629,12 @@ static boolean PIT_AddLineIntercepts(const line_t __far* ld)
   if (frac < 0)
     return true;        // behind source
 
-  if(!check_intercept())
+  intercept_t* in = P_InsertIntercept(frac);
+  if (!in)
     return false;
 
-  intercept_p->frac = frac;
-  intercept_p->isaline = true;
-  intercept_p->d.line = ld;
-  intercept_p++;
+  in->isaline = true;
+  in->d.line = ld;
 
   return true;  // continue
 }
@@ -547,13 +684,12 @@ static boolean PIT_AddThingIntercepts(mobj_t __far* thing)
   if (frac < 0)
     return true;                // behind source
 
-  if(!check_intercept())
+  intercept_t* in = P_InsertIntercept(frac);
+  if (!in)
       return false;
 
-  intercept_p->frac = frac;
-  intercept_p->isaline = false;
-  intercept_p->d.thing = thing;
-  intercept_p++;
+  in->isaline = false;
+  in->d.thing = thing;
 
   return true;          // keep going
 }
@@ -562,24 +698,18 @@ static boolean PIT_AddThingIntercepts(mobj_t __far* thing)
 // P_TraverseIntercepts
 // Returns true if the traverser function returns true
 // for all lines.
+// The intercepts are already sorted by P_InsertIntercept.
 //
 
 static boolean P_TraverseIntercepts(traverser_t func, fixed_t maxfrac)
 {
-  intercept_t *in = NULL;
-  int16_t count = intercept_p - intercepts;
-  while (count--)
+  intercept_t *in;
+  for (in = intercepts; in < intercept_p; in++)
     {
-      fixed_t dist = INT32_MAX;
-      intercept_t *scan;
-      for (scan = intercepts; scan < intercept_p; scan++)
-        if (scan->frac < dist)
-          dist = (in=scan)->frac;
-      if (dist > maxfrac)
+      if (in->frac > maxfrac)
         return true;    // checked everything in range
       if (!func(in))
         return false;           // don't bother going farther
-      in->frac = INT32_MAX;
     }
   return true;                  // everything was traversed
 }
@@ -619,6 +749,8 @@ boolean P_PathTraverse(fixed_t x1, fixed_t y1, fixed_t x2, fixed_t y2,
   _g_trace.dx = x2 - x1;
   _g_trace.dy = y2 - y1;
 
+  tracebatch.inuse = P_InTraceBatch(x1, y1, _g_trace.dx, _g_trace.dy);
+
   x1 -= _g_bmaporgx;
   y1 -= _g_bmaporgy;
   xt1 = x1>>MAPBLOCKSHIFT;
@@ -82,5 +82,8 @@ boolean P_BlockLinesIterator (int16_t x, int16_t y, boolean func(const line_t __
 boolean P_BlockThingsIterator(int16_t x, int16_t y, boolean func(mobj_t __far*));
 boolean P_PathTraverse(fixed_t x1, fixed_t y1, fixed_t x2, fixed_t y2,
                        int16_t flags, boolean trav(intercept_t *));
+void    P_InitTraceBatch(void);
+void    P_BeginTraceBatch(const mobj_t __far* t1, angle_t angle, angle_t spread);
+void    P_EndTraceBatch(void);
 
 #endif  /* __P_MAPUTL__ */
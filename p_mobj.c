@@ -772,12 +772,63 @@ static void P_NightmareRespawn(mobj_t __far* mobj)
 }
 
 
+//
+// Dormant monsters
+//
+// A monster that's standing still in A_Look, without a sound target,
+// in a sector that can't see the player's sector according to REJECT,
+// can't wake up until one of those changes.
+// Such a monster only thinks every DORMANTTICS tics.
+// Noise sets the sound target, damage and waking up change the state,
+// and the player moving to another sector changes the REJECT lookup,
+// so the monster is back to thinking every tic right away.
+//
+// This changes the timing of the idle animations,
+// so it's not demo compatible and not used during demo playback.
+//
+
+//#define DORMANT_MONSTERS
+
+#if defined DORMANT_MONSTERS
+#define DORMANTTICS 8
+
+static boolean P_IsDormant(const mobj_t __far* mobj)
+{
+    if (_g_demoplayback || !_g_player.mo)
+        return false;
+
+    if (!(mobj->flags & MF_COUNTKILL) || mobj->state->action != A_Look)
+        return false;
+
+    if (mobj->momx | mobj->momy | mobj->momz || mobj->z != mobj->floorz)
+        return false;
+
+    const sector_t __far* sector = mobj->subsector->sector;
+    if (sector->soundtarget)
+        return false;
+
+    int32_t pnum = (int32_t)(sector - _g_sectors) * _g_numsectors + (_g_player.mo->subsector->sector - _g_sectors);
+    if (!(_g_rejectmatrix[pnum >> 3] & (1 << (pnum & 7))))
+        return false;
+
+    // spread the dormant monsters over the tics
+    uint16_t spread = D_FP_SEG(mobj) ^ D_FP_OFF(mobj);
+    return ((_g_leveltime ^ spread) & (DORMANTTICS - 1)) != 0;
+}
+#endif
+
+
 void P_MobjThinker (mobj_t __far* mobj)
 {
     // killough 11/98:
     // removed old code which looked at target references
     // (we use pointer reference counting now)
 
+#if defined DORMANT_MONSTERS
+    if (P_IsDormant(mobj))
+        return;
+#endif
+
     // momentum movement
     if (mobj->momx | mobj->momy || mobj->flags & MF_SKULLFLY)
     {
@@ -837,7 +888,7 @@ void P_MobjThinker (mobj_t __far* mobj)
 //Thinker function for stuff that doesn't need to do anything
 //interesting.
 //Just cycles through the states. Allows sprite animation to work.
-static void P_MobjBrainlessThinker(mobj_t __far* mobj)
+void P_MobjBrainlessThinker(mobj_t __far* mobj)
 {
     // cycle through states,
     // calling action functions at transitions
@@ -869,32 +920,57 @@ static think_t P_ThinkerFunctionForType(mobjtype_t type, mobj_t __far* mobj)
     return NULL;
 }
 
+//
+// Thing pool
+//
+// Free mobjs are linked through their thinker's next pointer.
+// The pool starts with room for the things of the map,
+// and grows by THINGPOOLCHUNK mobjs at a time.
+// Pooled memory is freed when the level ends.
+//
+
+#define THINGPOOLCHUNK 8
+
+static mobj_t __far* thingfreelist;
+
+
+void P_FreeMobj(mobj_t __far* mobj)
+{
+    mobj->type = MT_NOTHING;
+    mobj->thinker.next = (thinker_t __far*)thingfreelist;
+    thingfreelist = mobj;
+}
+
+
+void P_InitThingPool(int16_t numthings)
+{
+    thingfreelist = NULL;
+
+    mobj_t __far* pool = Z_MallocLevel(numthings * sizeof(mobj_t), NULL);
+
+    for (int16_t i = numthings - 1; i >= 0; i--)
+        P_FreeMobj(&pool[i]);
+}
+
+
 //
 // P_SpawnMobj
 //
 
 static mobj_t __far* P_NewMobj()
 {
-    mobj_t __far* mobj = NULL;
-
-    for(int16_t i = _g_thingPoolSize-1; i >= 0; i--)
+    if (thingfreelist == NULL)
     {
-        if(_g_thingPool[i].type == MT_NOTHING)
-        {
-            mobj = &_g_thingPool[i];
-            _fmemset (mobj, 0, sizeof (*mobj));
+        mobj_t __far* chunk = Z_MallocLevel(THINGPOOLCHUNK * sizeof(mobj_t), NULL);
 
-            mobj->flags = MF_POOLED;
-            return mobj;
-        }
+        for (int16_t i = THINGPOOLCHUNK - 1; i >= 0; i--)
+            P_FreeMobj(&chunk[i]);
     }
 
-    if(mobj == NULL)
-    {
-        mobj = Z_MallocLevel(sizeof(*mobj), NULL);
-        _fmemset (mobj, 0, sizeof (*mobj));
-    }
+    mobj_t __far* mobj = thingfreelist;
+    thingfreelist = (mobj_t __far*)mobj->thinker.next;
 
+    _fmemset (mobj, 0, sizeof (*mobj));
     return mobj;
 }
 
@@ -947,7 +1023,14 @@ mobj_t __far* P_SpawnMobj(fixed_t x,fixed_t y,fixed_t z,mobjtype_t type)
     mobj->thinker.function = P_ThinkerFunctionForType(type, mobj);
 
     mobj->target = mobj->tracer = mobj->lastenemy = NULL;
-    P_AddThinker (&mobj->thinker);
+
+    if (mobj->thinker.function == P_MobjThinker)
+        P_AddThinkerToClass(&mobj->thinker, TH_MAIN);
+    else if (mobj->thinker.function)
+        P_AddThinkerToClass(&mobj->thinker, TH_ANIMATED);
+    else
+        P_AddThinkerToClass(&mobj->thinker, TH_INERT);
+
     if (!((mobj->flags ^ MF_COUNTKILL) & (MF_FRIEND | MF_COUNTKILL)))
         _g_totallive++;
     return mobj;
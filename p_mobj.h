@@ -189,8 +189,6 @@
 // Neither a cacodemon nor a missile.
 #define MF_SKULLFLY     (uint32_t)(0x0000000001000000)
 
-#define MF_POOLED       (uint32_t)(0x0000000010000000)
-
 #define MF_FRIEND       (uint32_t)(0x0000000080000000)
 
 
@@ -312,9 +310,12 @@ typedef struct mobj_s
 
 mobj_t __far* P_SpawnMobj(fixed_t x, fixed_t y, fixed_t z, mobjtype_t type);
 void    P_RemoveMobj(mobj_t __far* th);
+void    P_InitThingPool(int16_t numthings);
+void    P_FreeMobj(mobj_t __far* mobj);
 boolean P_SetMobjState(mobj_t __far* mobj, statenum_t state);
 
 void    P_MobjThinker(mobj_t __far* mobj);
+void    P_MobjBrainlessThinker(mobj_t __far* mobj);
 
 void    P_SpawnPuff(fixed_t x, fixed_t y, fixed_t z);
 void    P_SpawnBlood(fixed_t x, fixed_t y, fixed_t z, int16_t damage);
@@ -231,7 +231,7 @@ boolean EV_DoPlat(const line_t __far* line, plattype_e type, int16_t amount)
 
     // Create a thinker
     rtn = true;
-    plat = Z_CallocLevSpec(sizeof(*plat));
+    plat = P_CallocThinker(TP_MOVER);
     P_AddThinker(&plat->thinker);
 
     plat->type = type;
@@ -37,6 +37,7 @@
 #include "d_player.h"
 #include "r_main.h"
 #include "p_map.h"
+#include "p_maputl.h"
 #include "p_inter.h"
 #include "p_pspr.h"
 #include "p_enemy.h"
@@ -806,8 +807,12 @@ void A_FireShotgun(player_t *player, pspdef_t *psp)
 
 	P_BulletSlope(player->mo);
 
+	P_BeginTraceBatch(player->mo, player->mo->angle, 255 << 18);
+
 	for (i=0; i<7; i++)
 		P_GunShot(player->mo, false);
+
+	P_EndTraceBatch();
 }
 
 
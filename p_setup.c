@@ -36,7 +36,9 @@
 
 #include <math.h>
 #include <stdint.h>
+#include <stdio.h>
 
+#include "compiler.h"
 #include "d_player.h"
 #include "g_game.h"
 #include "w_wad.h"
@@ -114,9 +116,6 @@ mobj_t    __far*__far* _g_blocklinks;           // for thing chains
 
 const byte __far* _g_rejectmatrix;
 
-mobj_t __far*      _g_thingPool;
-int16_t _g_thingPoolSize;
-
 
 // Lump order in a map WAD: each map needs a couple of lumps
 // to provide a complete scene geometry description.
@@ -135,6 +134,49 @@ enum {
 };
 
 
+//
+// P_ReadMapLumps
+//
+// The map lumps are stored one after another, in the order of the enum above.
+// Reading them in that order is one sequential pass over the file,
+// instead of seeking back and forth for every P_Load* function.
+// A lump that doesn't fit in memory yet is read by its P_Load* function.
+// The lumps that are in the level cache are skipped.
+//
+
+static int16_t maplumpnum;
+static const void __far* maplumps[ML_BLOCKMAP + 1];
+
+static void P_ReadMapLumps(int16_t lumpnum, boolean precompiled)
+{
+  maplumpnum = lumpnum;
+
+  for (int16_t i = ML_THINGS; i <= ML_BLOCKMAP; i++)
+  {
+    uint16_t size = W_LumpLength(lumpnum + i);
+
+    if (precompiled && (i == ML_SIDEDEFS || i == ML_SSECTORS || i == ML_SECTORS))
+      maplumps[i] = NULL;
+    else if (size && Z_IsEnoughFreeMemory(size))
+    {
+      void __far* ptr = Z_MallocLevel(size, NULL);
+      W_ReadLumpByNum(lumpnum + i, ptr);
+      maplumps[i] = ptr;
+    }
+    else
+      maplumps[i] = NULL;
+  }
+}
+
+
+static const void __far* P_GetMapLump(int16_t lump)
+{
+  const void __far* ptr = maplumps[lump - maplumpnum];
+  return ptr ? ptr : W_GetLumpByNumAutoFree(lump);
+}
+
+
+
 //
 // P_LoadVertexes
 //
@@ -147,7 +189,7 @@ static void P_LoadVertexes (int16_t lump)
   _g_numvertexes = W_LumpLength(lump) / sizeof(vertex_t);
 
   // Allocate zone memory for buffer.
-  _g_vertexes = W_GetLumpByNumAutoFree(lump);
+  _g_vertexes = P_GetMapLump(lump);
 
 }
 
@@ -159,7 +201,7 @@ static void P_LoadVertexes (int16_t lump)
 static void P_LoadSegs (int16_t lump)
 {
     int16_t numsegs = W_LumpLength(lump) / sizeof(seg_t);
-    _g_segs = (const seg_t __far*)W_GetLumpByNumAutoFree(lump);
+    _g_segs = (const seg_t __far*)P_GetMapLump(lump);
 
     if (!numsegs)
       I_Error("P_LoadSegs: no segs in level");
@@ -184,7 +226,7 @@ static void P_LoadSubsectors (int16_t lump)
 
   numsubsectors = W_LumpLength (lump) / sizeof(mapsubsector_t);
   _g_subsectors = Z_CallocLevel(numsubsectors * sizeof(subsector_t));
-  data = (const mapsubsector_t __far*)W_GetLumpByNumAutoFree(lump);
+  data = (const mapsubsector_t __far*)P_GetMapLump(lump);
 
   if ((!data) || (!numsubsectors))
     I_Error("P_LoadSubsectors: no subsectors in level");
@@ -226,7 +268,7 @@ static void P_LoadSectors (int16_t lump)
 
   _g_numsectors = W_LumpLength (lump) / sizeof(mapsector_t);
   _g_sectors = Z_CallocLevel(_g_numsectors * sizeof(sector_t));
-  data = W_GetLumpByNumAutoFree (lump); // cph - wad lump handling updated
+  data = P_GetMapLump(lump); // cph - wad lump handling updated
 
   for (i=0; i<_g_numsectors; i++)
     {
@@ -257,7 +299,7 @@ static void P_LoadSectors (int16_t lump)
 static void P_LoadNodes (int16_t lump)
 {
   numnodes = W_LumpLength (lump) / sizeof(mapnode_t);
-  nodes = W_GetLumpByNumAutoFree (lump); // cph - wad lump handling updated
+  nodes = P_GetMapLump(lump); // cph - wad lump handling updated
 
   if ((!nodes) || (!numnodes))
   {
@@ -324,18 +366,12 @@ static boolean P_IsDoomnumAllowed(int16_t doomnum)
 static void P_LoadThings (int16_t lump)
 {
     int16_t  i, numthings = W_LumpLength (lump) / sizeof(mapthing_t);
-    const mapthing_t __far* data = W_GetLumpByNumAutoFree (lump);
+    const mapthing_t __far* data = P_GetMapLump(lump);
 
     if ((!data) || (!numthings))
         I_Error("P_LoadThings: no things in level");
 
-    _g_thingPool = Z_CallocLevel(numthings * sizeof(mobj_t));
-    _g_thingPoolSize = numthings;
-
-    for(int16_t i = 0; i < numthings; i++)
-    {
-        _g_thingPool[i].type = MT_NOTHING;
-    }
+    P_InitThingPool(numthings);
 
     for (i=0; i<numthings; i++)
     {
@@ -365,7 +401,7 @@ static void P_LoadLineDefs (int16_t lump)
     int16_t  i;
 
     _g_numlines = W_LumpLength (lump) / sizeof(line_t);
-    _g_lines = W_GetLumpByNumAutoFree (lump);
+    _g_lines = P_GetMapLump(lump);
 
     _g_linedata = Z_CallocLevel(_g_numlines * sizeof(linedata_t));
 
@@ -405,7 +441,7 @@ static void P_LoadSideDefs (int16_t lump)
 
 static void P_LoadSideDefs2(int16_t lump)
 {
-    const byte __far* data = W_GetLumpByNumAutoFree(lump); // cph - const*, wad lump handling updated
+    const byte __far* data = P_GetMapLump(lump); // cph - const*, wad lump handling updated
 
     for (int16_t i = 0; i < numsides; i++)
     {
@@ -447,7 +483,7 @@ static void P_LoadSideDefs2(int16_t lump)
 
 static void P_LoadBlockMap (int16_t lump)
 {
-    _g_blockmaplump = W_GetLumpByNumAutoFree(lump);
+    _g_blockmaplump = P_GetMapLump(lump);
 
     _g_bmaporgx = ((int32_t)_g_blockmaplump[0])<<FRACBITS;
     _g_bmaporgy = ((int32_t)_g_blockmaplump[1])<<FRACBITS;
@@ -467,7 +503,242 @@ static void P_LoadBlockMap (int16_t lump)
 
 static void P_LoadReject(int16_t lump)
 {
-  _g_rejectmatrix = W_GetLumpByNumAutoFree(lump);
+  _g_rejectmatrix = P_GetMapLump(lump);
+}
+
+//
+// P_BuildReject
+// Adds the sector pairs that can never see each other to REJECT.
+//
+// Sectors are grouped through the two-sided lines that are open,
+// or that may open because a sector next to them can move.
+// Sectors in different groups are walled off from each other.
+//
+
+#define RJ_MOVES  1
+#define RJ_STAIRS 2
+
+static boolean P_IsStairSpecial(int16_t special)
+{
+  return special == 7 || special == 8 || special == 100 || special == 127
+      || (256 <= special && special <= 259)
+      || ((uint16_t)special >= GenStairsBase && (uint16_t)special < GenLiftBase);
+}
+
+static boolean P_IsDonutSpecial(int16_t special)
+{
+  return special == 9 || special == 146 || special == 155 || special == 191;
+}
+
+// Line specials that don't move the sectors tagged like the line.
+// A line with any other special and tag 0 moves every untagged sector.
+static boolean P_MovesTaggedSectors(int16_t special)
+{
+  if ((uint16_t)special >= GenCrusherBase)
+    return (special & TriggerType) < PushOnce;
+
+  switch (special)
+  {
+    case 1: case 26: case 27: case 28: case 31: case 32: case 33: case 34: case 117: case 118: // manual doors
+    case 11: case 51: case 52: case 124:                                                      // exits
+    case 39: case 97: case 125: case 126:                                                     // teleports
+    case 12: case 13: case 17: case 35: case 79: case 80: case 81: case 104: case 138: case 139: // lights
+    case 48:                                                                                  // scroller
+      return false;
+    default:
+      return true;
+  }
+}
+
+static int16_t P_RejectGroup(int16_t __far* group, int16_t s)
+{
+  while (group[s] != s)
+    s = group[s] = group[group[s]];
+
+  return s;
+}
+
+static uint16_t P_RejectRatio(const byte __far* reject, uint16_t size, int32_t pairs)
+{
+  int32_t count = 0;
+
+  for (uint16_t i = 0; i < size; i++)
+    for (byte b = reject[i]; b; b &= b - 1)
+      count++;
+
+  return count * 100 / pairs;
+}
+
+// reported by -timedemo, for the last map
+uint16_t _g_rejectbefore;
+uint16_t _g_rejectafter;
+int32_t  _g_rejecttics;
+
+static void P_BuildReject(int16_t lump)
+{
+  _g_rejectbefore = _g_rejectafter = 0;
+  _g_rejecttics = 0;
+
+  int32_t pairs = (int32_t)_g_numsectors * _g_numsectors;
+  if (pairs > 0xffffL * 8)
+    return;
+
+  int32_t starttime = I_GetTime();
+
+  uint16_t size = (pairs + 7) / 8;
+  uint16_t __far* movable = Z_TryMallocStatic(_g_numsectors * (sizeof(int16_t) + sizeof(uint16_t)));
+  if (!movable)
+    return;
+
+  int16_t __far* group = (int16_t __far*)(movable + _g_numsectors);
+
+  for (int16_t s = 0; s < _g_numsectors; s++)
+  {
+    // sector types 10 and 14 spawn a door without a line
+    int16_t special = _g_sectors[s].special & 31;
+    movable[s] = _g_sectors[s].tag || special == 10 || special == 14 ? RJ_MOVES : 0;
+    group[s]   = s;
+  }
+
+  // Manual doors and lifts move the sector behind their line,
+  // a donut moves the pool around its pillar,
+  // and stairs go up from sector to sector.
+  for (int16_t i = 0; i < _g_numlines; i++)
+  {
+    const line_t __far* line = &_g_lines[i];
+    int16_t special = line->const_special;
+
+    if (!special)
+      continue;
+
+    if (!line->tag && P_MovesTaggedSectors(special))
+    {
+      Z_Free(movable);
+      return;
+    }
+
+    movable[LN_FRONTSECTOR(line) - _g_sectors] |= RJ_MOVES;
+    if (LN_BACKSECTOR(line))
+      movable[LN_BACKSECTOR(line) - _g_sectors] |= RJ_MOVES;
+
+    boolean stairs = P_IsStairSpecial(special);
+    if (stairs || P_IsDonutSpecial(special))
+    {
+      for (int16_t s = 0; s < _g_numsectors; s++)
+      {
+        if (_g_sectors[s].tag != line->tag)
+          continue;
+
+        if (stairs)
+          movable[s] |= RJ_STAIRS;
+        else
+        {
+          for (int16_t j = 0; j < _g_sectors[s].linecount; j++)
+          {
+            const line_t __far* l = _g_sectors[s].lines[j];
+            if (LN_BACKSECTOR(l))
+            {
+              movable[LN_FRONTSECTOR(l) - _g_sectors] |= RJ_MOVES;
+              movable[LN_BACKSECTOR(l)  - _g_sectors] |= RJ_MOVES;
+            }
+          }
+        }
+      }
+    }
+  }
+
+  boolean changed;
+  do
+  {
+    changed = false;
+    for (int16_t i = 0; i < _g_numlines; i++)
+    {
+      const line_t __far* line = &_g_lines[i];
+      const sector_t __far* back = LN_BACKSECTOR(line);
+
+      if (back && (movable[LN_FRONTSECTOR(line) - _g_sectors] & RJ_STAIRS)
+               && !(movable[back - _g_sectors] & RJ_STAIRS))
+      {
+        movable[back - _g_sectors] |= RJ_STAIRS | RJ_MOVES;
+        changed = true;
+      }
+    }
+  } while (changed);
+
+  int16_t groups = _g_numsectors;
+  for (int16_t i = 0; i < _g_numlines; i++)
+  {
+    const line_t __far* line = &_g_lines[i];
+    const sector_t __far* front = LN_FRONTSECTOR(line);
+    const sector_t __far* back  = LN_BACKSECTOR(line);
+
+    if (!back)
+      continue;
+
+    int16_t f = front - _g_sectors;
+    int16_t b = back  - _g_sectors;
+
+    if (!movable[f] && !movable[b])
+    {
+      fixed_t opentop    = front->ceilingheight < back->ceilingheight ? front->ceilingheight : back->ceilingheight;
+      fixed_t openbottom = front->floorheight   > back->floorheight   ? front->floorheight   : back->floorheight;
+      if (openbottom >= opentop)
+        continue;
+    }
+
+    f = P_RejectGroup(group, f);
+    b = P_RejectGroup(group, b);
+    if (f != b)
+    {
+      group[f] = b;
+      groups--;
+    }
+  }
+
+  if (groups > 1)
+  {
+    byte __far* reject;
+    uint16_t lumplength = W_LumpLength(lump);
+
+    if (maplumps[ML_REJECT] && lumplength >= size)
+      reject = (byte __far*)maplumps[ML_REJECT];
+    else if (Z_IsEnoughFreeMemory(size))
+    {
+      reject = Z_MallocLevel(size, NULL);
+      if (lumplength > size)
+        lumplength = size;
+      _fmemcpy(reject, _g_rejectmatrix, lumplength);
+      _fmemset(reject + lumplength, 0, size - lumplength);
+    }
+    else
+    {
+      Z_Free(movable);
+      return;
+    }
+
+    if (_g_timingdemo)
+      _g_rejectbefore = P_RejectRatio(reject, size, pairs);
+
+    // movable now holds the group of each sector
+    for (int16_t s = 0; s < _g_numsectors; s++)
+      movable[s] = P_RejectGroup(group, s);
+
+    int32_t pnum = 0;
+    for (int16_t s1 = 0; s1 < _g_numsectors; s1++)
+      for (int16_t s2 = 0; s2 < _g_numsectors; s2++, pnum++)
+        if (movable[s1] != movable[s2])
+          reject[pnum >> 3] |= 1 << (pnum & 7);
+
+    _g_rejectmatrix = reject;
+
+    if (_g_timingdemo)
+    {
+      _g_rejectafter = P_RejectRatio(reject, size, pairs);
+      _g_rejecttics  = I_GetTime() - starttime;
+    }
+  }
+
+  Z_Free(movable);
 }
 
 //
@@ -505,6 +776,63 @@ static void M_AddToBox(fixed_t* box,fixed_t x,fixed_t y)
         box[BOXTOP]    = y;
 }
 
+//
+// P_GroupNeighbours
+// Builds the sector neighbour lists from the sector line lists.
+//
+
+// Fills list with the sector numbers of the neighbours, returns the count
+static int16_t P_FindNeighbours(const sector_t __far* sector, int16_t __far* list)
+{
+    int16_t count = 0;
+
+    for (int16_t l = 0; l < sector->linecount; l++)
+    {
+        const sector_t __far* other = getNextSector(sector->lines[l], sector);
+        if (!other)
+            continue;
+
+        int16_t num = other - _g_sectors;
+
+        int16_t n = 0;
+        while (n < count && list[n] != num)
+            n++;
+
+        if (n == count)
+            list[count++] = num;
+    }
+
+    return count;
+}
+
+static void P_GroupNeighbours(void)
+{
+    // count the neighbours first, in a scratch list
+    int16_t maxlinecount = 0;
+    for (int16_t i = 0; i < _g_numsectors; i++)
+        maxlinecount = MAX(maxlinecount, _g_sectors[i].linecount);
+
+    int16_t __far* scratch = Z_MallocStatic(maxlinecount * sizeof(int16_t));
+
+    int16_t total = 0;
+    for (int16_t i = 0; i < _g_numsectors; i++)
+        total += P_FindNeighbours(&_g_sectors[i], scratch);
+
+    Z_Free(scratch);
+
+    int16_t __far* buffer = Z_MallocLevel(total * sizeof(int16_t), NULL);
+
+    for (int16_t i = 0; i < _g_numsectors; i++)
+    {
+        sector_t __far* sector = &_g_sectors[i];
+
+        sector->neighbours     = buffer;
+        sector->neighbourcount = P_FindNeighbours(sector, buffer);
+
+        buffer += sector->neighbourcount;
+    }
+}
+
 static void P_GroupLines (void)
 {
     register const line_t __far* li;
@@ -573,6 +901,278 @@ static void P_GroupLines (void)
         sector->soundorg.x = bbox[BOXRIGHT]/2+bbox[BOXLEFT]/2;
         sector->soundorg.y = bbox[BOXTOP]/2+bbox[BOXBOTTOM]/2;
     }
+
+    P_GroupNeighbours();
+}
+
+
+//
+// Level cache
+//
+// The sectors, sides and subsectors after P_GroupLines,
+// stored in one file per map, so the next time the map is loaded
+// they can be read in, instead of being built again.
+// Pointers are stored as indices.
+// The sector line lists are stored in sector order,
+// so sector->lines follows from the line counts.
+// The neighbour lists are built again from the line lists.
+//
+// The cache is rebuilt when the WAD or the structures change.
+//
+
+#define LEVELCACHEID "LVC1"
+
+typedef struct
+{
+  char     id[4];
+  uint32_t checksum;        // W_Checksum of the WAD it was built from
+  uint16_t sectorsize;
+  uint16_t sidesize;
+  uint16_t subsectorsize;
+  int16_t  numlines;
+  int16_t  numsectors;
+  int16_t  numsides;
+  int16_t  numsubsectors;
+  int16_t  numlinerefs;     // total length of the sector line lists
+} levelcache_t;
+
+
+static void P_LevelCacheHeader(levelcache_t* header)
+{
+  memcpy(header->id, LEVELCACHEID, sizeof(header->id));
+  header->checksum      = W_Checksum();
+  header->sectorsize    = sizeof(sector_t);
+  header->sidesize      = sizeof(side_t);
+  header->subsectorsize = sizeof(subsector_t);
+}
+
+
+// reads the indices a buffer at a time
+typedef struct
+{
+  wadfile_t file;
+  uint16_t  count;          // indices left in the buffer
+  uint16_t  next;
+  uint16_t  buffer[64];
+} indexreader_t;
+
+
+static boolean P_ReadFar(wadfile_t file, void __far* ptr, uint16_t size)
+{
+  return W_ReadFile(file, ptr, size) == size;
+}
+
+
+static boolean P_ReadIndex(indexreader_t* reader, uint16_t* index, uint16_t count)
+{
+  if (!reader->count)
+  {
+    reader->count = W_ReadFile(reader->file, reader->buffer, sizeof(reader->buffer)) / sizeof(uint16_t);
+    reader->next  = 0;
+    if (!reader->count)
+      return false;
+  }
+
+  reader->count--;
+  *index = reader->buffer[reader->next++];
+  return *index < count;
+}
+
+
+//
+// P_OpenLevelCache
+// Returns false if there's no cache for this map,
+// or if it was built from another WAD.
+//
+static boolean P_OpenLevelCache(const char* filename, int16_t lumpnum, wadfile_t* file)
+{
+  if (!W_OpenFile(filename, file))
+    return false;
+
+  levelcache_t header, expected;
+  P_LevelCacheHeader(&expected);
+
+  if (!P_ReadFar(*file, &header, sizeof(header))
+    || memcmp(header.id,  expected.id, sizeof(header.id))
+    || header.checksum      != expected.checksum
+    || header.sectorsize    != expected.sectorsize
+    || header.sidesize      != expected.sidesize
+    || header.subsectorsize != expected.subsectorsize
+    || header.numlines      != W_LumpLength(lumpnum + ML_LINEDEFS) / sizeof(line_t))
+  {
+    W_CloseFile(*file);
+    return false;
+  }
+
+  W_SeekFile(*file, 0);
+  return true;
+}
+
+
+//
+// P_LoadLevelCache
+// Replaces P_LoadSideDefs, P_LoadSectors, P_LoadSideDefs2,
+// P_LoadSubsectors and P_GroupLines.
+// Returns false if the cache turns out to be unusable.
+//
+static boolean P_LoadLevelCache(wadfile_t file)
+{
+  levelcache_t header;
+  if (!P_ReadFar(file, &header, sizeof(header)))
+    return false;
+
+  _g_numsectors = header.numsectors;
+  numsides      = header.numsides;
+  numsubsectors = header.numsubsectors;
+
+  _g_sectors    = Z_MallocLevel(_g_numsectors * sizeof(sector_t),    NULL);
+  _g_sides      = Z_MallocLevel(numsides      * sizeof(side_t),      NULL);
+  _g_subsectors = Z_MallocLevel(numsubsectors * sizeof(subsector_t), NULL);
+
+  const line_t __far*__far* linebuffer = Z_MallocLevel(header.numlinerefs * sizeof(line_t __far*), NULL);
+
+  if (!P_ReadFar(file, _g_sectors,    _g_numsectors * sizeof(sector_t))
+   || !P_ReadFar(file, _g_sides,      numsides      * sizeof(side_t))
+   || !P_ReadFar(file, _g_subsectors, numsubsectors * sizeof(subsector_t)))
+    goto fail;
+
+  indexreader_t reader;
+  reader.file  = file;
+  reader.count = 0;
+
+  uint16_t index;
+
+  for (int16_t i = 0; i < numsides; i++)
+  {
+    if (!P_ReadIndex(&reader, &index, _g_numsectors))
+      goto fail;
+    _g_sides[i].sector = &_g_sectors[index];
+  }
+
+  for (int16_t i = 0; i < numsubsectors; i++)
+  {
+    if (!P_ReadIndex(&reader, &index, _g_numsectors))
+      goto fail;
+    _g_subsectors[i].sector = &_g_sectors[index];
+  }
+
+  int16_t numlinerefs = 0;
+  for (int16_t i = 0; i < _g_numsectors; i++)
+  {
+    sector_t __far* sector = &_g_sectors[i];
+
+    numlinerefs += sector->linecount;
+    if (numlinerefs > header.numlinerefs)
+      goto fail;
+
+    sector->lines = linebuffer;
+
+    for (int16_t l = 0; l < sector->linecount; l++)
+    {
+      if (!P_ReadIndex(&reader, &index, _g_numlines))
+        goto fail;
+      *linebuffer++ = &_g_lines[index];
+    }
+  }
+
+  // the textures are loaded by P_LoadSideDefs2
+  for (int16_t i = 0; i < numsides; i++)
+  {
+    R_GetTexture(_g_sides[i].midtexture);
+    R_GetTexture(_g_sides[i].toptexture);
+    R_GetTexture(_g_sides[i].bottomtexture);
+  }
+
+  P_GroupNeighbours();
+
+  return true;
+
+fail:
+  Z_Free(linebuffer);
+  Z_Free(_g_subsectors);
+  Z_Free(_g_sides);
+  Z_Free(_g_sectors);
+  return false;
+}
+
+
+//
+// P_SaveLevelCache
+// Writing is best effort, a missing cache only costs time.
+// -nolvcsave turns it off.
+//
+boolean _g_nolvcsave;
+
+static void P_SaveLevelCache(const char* filename)
+{
+  if (_g_nolvcsave)
+    return;
+
+  FILE* fp = fopen(filename, "wb");
+  if (fp == NULL)
+    return;
+
+  levelcache_t header;
+  P_LevelCacheHeader(&header);
+  header.numlines      = _g_numlines;
+  header.numsectors    = _g_numsectors;
+  header.numsides      = numsides;
+  header.numsubsectors = numsubsectors;
+  header.numlinerefs   = 0;
+  for (int16_t i = 0; i < _g_numsectors; i++)
+    header.numlinerefs += _g_sectors[i].linecount;
+
+  boolean ok = fwrite(&header, sizeof(header), 1, fp) == 1;
+
+  // the images, without pointers
+  for (int16_t i = 0; i < _g_numsectors; i++)
+  {
+    sector_t sector = _g_sectors[i];
+    sector.lines = NULL;
+    sector.neighbours = NULL;
+    ok &= fwrite(&sector, sizeof(sector), 1, fp) == 1;
+  }
+
+  for (int16_t i = 0; i < numsides; i++)
+  {
+    side_t side = _g_sides[i];
+    side.sector = NULL;
+    ok &= fwrite(&side, sizeof(side), 1, fp) == 1;
+  }
+
+  for (int16_t i = 0; i < numsubsectors; i++)
+  {
+    subsector_t subsector = _g_subsectors[i];
+    subsector.sector = NULL;
+    ok &= fwrite(&subsector, sizeof(subsector), 1, fp) == 1;
+  }
+
+  // the pointers
+  uint16_t index;
+
+  for (int16_t i = 0; i < numsides; i++)
+  {
+    index = _g_sides[i].sector - _g_sectors;
+    ok &= fwrite(&index, sizeof(index), 1, fp) == 1;
+  }
+
+  for (int16_t i = 0; i < numsubsectors; i++)
+  {
+    index = _g_subsectors[i].sector - _g_sectors;
+    ok &= fwrite(&index, sizeof(index), 1, fp) == 1;
+  }
+
+  for (int16_t i = 0; i < _g_numsectors; i++)
+  {
+    for (int16_t l = 0; l < _g_sectors[i].linecount; l++)
+    {
+      index = _g_sectors[i].lines[l] - _g_lines;
+      ok &= fwrite(&index, sizeof(index), 1, fp) == 1;
+    }
+  }
+
+  if (fclose(fp) != 0 || !ok)
+    remove(filename);
 }
 
 
@@ -589,6 +1189,7 @@ static void R_ResetPlanes()
 static void P_FreeLevelData()
 {
     R_ResetPlanes();
+    R_ClearSpriteCache();
 
     Z_FreeTags();
 }
@@ -601,6 +1202,7 @@ void P_SetupLevel(int16_t map)
 {
     int_fast8_t   i;
     char  lumpname[9];
+    char  cachename[13];
     int16_t   lumpnum;
 
     _g_totallive = _g_totalkills = _g_totalitems = _g_totalsecret = 0;
@@ -618,6 +1220,7 @@ void P_SetupLevel(int16_t map)
     P_FreeLevelData();
 
     P_InitThinkers();
+    P_ClearSightCache();
 
     _g_leveltime = 0;
     _g_totallive = 0;
@@ -627,18 +1230,41 @@ void P_SetupLevel(int16_t map)
 
     lumpnum = W_GetNumForName(lumpname);
 
+    sprintf(cachename, "%s.LVC", lumpname);
+    wadfile_t cache;
+    boolean cached = P_OpenLevelCache(cachename, lumpnum, &cache);
+
+    P_ReadMapLumps(lumpnum, cached);
+
     P_LoadLineDefs  (lumpnum + ML_LINEDEFS);
     P_LoadSegs      (lumpnum + ML_SEGS);
-    P_LoadSideDefs  (lumpnum + ML_SIDEDEFS);
-    P_LoadSectors   (lumpnum + ML_SECTORS);
-    P_LoadSideDefs2 (lumpnum + ML_SIDEDEFS);
-    P_LoadSubsectors(lumpnum + ML_SSECTORS);
+
+    boolean precompiled = cached && P_LoadLevelCache(cache);
+    if (cached)
+        W_CloseFile(cache);
+
+    if (!precompiled)
+    {
+        P_LoadSideDefs  (lumpnum + ML_SIDEDEFS);
+        P_LoadSectors   (lumpnum + ML_SECTORS);
+        P_LoadSideDefs2 (lumpnum + ML_SIDEDEFS);
+        P_LoadSubsectors(lumpnum + ML_SSECTORS);
+    }
+
     P_LoadNodes     (lumpnum + ML_NODES);
     P_LoadBlockMap  (lumpnum + ML_BLOCKMAP);
     P_LoadVertexes  (lumpnum + ML_VERTEXES);
     P_LoadReject    (lumpnum + ML_REJECT);
 
-    P_GroupLines();
+    if (!precompiled)
+    {
+        P_GroupLines();
+        P_SaveLevelCache(cachename);
+    }
+
+    P_BuildReject   (lumpnum + ML_REJECT);
+    P_InitTagLists();
+    P_InitTraceBatch();
 
     // Note: you don't need to clear player queue slots
     // a much simpler fix is in g_game.c
@@ -54,6 +54,79 @@ typedef struct {
 static los_t los;
 
 
+//
+// Sight cache
+// Remembers the outcome of the BSP walk for recent pairs of things.
+// An entry is only valid while neither thing moved, for the current tic,
+// and until a floor or ceiling moves.
+//
+
+#define SIGHTCACHESIZE 8
+
+typedef struct {
+  const mobj_t __far* t1;
+  const mobj_t __far* t2;
+  fixed_t x1, y1, z1, h1;
+  fixed_t x2, y2, z2, h2;
+  boolean visible;
+} sightcache_t;
+
+static sightcache_t sightcache[SIGHTCACHESIZE];
+static int16_t sightcachecount;
+static int16_t sightcachenext;
+static int32_t sightcachetime;
+
+uint32_t _g_sightcachehits;
+uint32_t _g_sightcachemisses;
+
+
+void P_ClearSightCache(void)
+{
+  sightcachecount = 0;
+  sightcachenext  = 0;
+}
+
+
+static sightcache_t* P_FindSightCache(const mobj_t __far* t1, const mobj_t __far* t2)
+{
+  if (sightcachetime != _g_leveltime)
+  {
+    sightcachetime = _g_leveltime;
+    P_ClearSightCache();
+    return NULL;
+  }
+
+  for (int16_t i = 0; i < sightcachecount; i++)
+  {
+    sightcache_t* sc = &sightcache[i];
+    if (sc->t1 == t1 && sc->t2 == t2
+     && sc->x1 == t1->x && sc->y1 == t1->y && sc->z1 == t1->z && sc->h1 == t1->height
+     && sc->x2 == t2->x && sc->y2 == t2->y && sc->z2 == t2->z && sc->h2 == t2->height)
+      return sc;
+  }
+
+  return NULL;
+}
+
+
+static boolean P_AddSightCache(const mobj_t __far* t1, const mobj_t __far* t2, boolean visible)
+{
+  sightcache_t* sc = &sightcache[sightcachenext];
+
+  sc->t1 = t1;
+  sc->x1 = t1->x; sc->y1 = t1->y; sc->z1 = t1->z; sc->h1 = t1->height;
+  sc->t2 = t2;
+  sc->x2 = t2->x; sc->y2 = t2->y; sc->z2 = t2->z; sc->h2 = t2->height;
+  sc->visible = visible;
+
+  sightcachenext = (sightcachenext + 1) & (SIGHTCACHESIZE - 1);
+  if (sightcachecount < SIGHTCACHESIZE)
+    sightcachecount++;
+
+  return visible;
+}
+
+
 //
 // P_DivlineSide
 // Returns side 0 (front), 1 (back), or 2 (on).
@@ -233,6 +306,15 @@ boolean P_CheckSight(mobj_t __far* t1, mobj_t __far* t2)
   if (t1->subsector == t2->subsector)
     return true;
 
+  const sightcache_t* sc = P_FindSightCache(t1, t2);
+  if (sc)
+  {
+    _g_sightcachehits++;
+    return sc->visible;
+  }
+
+  _g_sightcachemisses++;
+
   // An unobstructed LOS is possible.
   // Now look from eyes of t1 to any part of t2.
 
@@ -258,5 +340,5 @@ boolean P_CheckSight(mobj_t __far* t1, mobj_t __far* t2)
     los.maxz = INT32_MAX; los.minz = INT32_MIN;
 
   // the head node is the last node output
-  return P_CrossBSPNode(numnodes-1);
+  return P_AddSightCache(t1, t2, P_CrossBSPNode(numnodes-1));
 }
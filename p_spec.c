@@ -121,17 +121,12 @@ sector_t __far* getNextSector(const line_t __far* line, sector_t __far* sec)
 fixed_t P_FindLowestFloorSurrounding(sector_t __far* sec)
 {
   int16_t                 i;
-  const line_t __far*             check;
-  sector_t __far*           other;
+  const sector_t __far*     other;
   fixed_t             floor = sec->floorheight;
 
-  for (i=0 ;i < sec->linecount ; i++)
+  for (i=0 ;i < sec->neighbourcount ; i++)
   {
-    check = sec->lines[i];
-    other = getNextSector(check,sec);
-
-    if (!other)
-      continue;
+    other = &_g_sectors[sec->neighbours[i]];
 
     if (other->floorheight < floor)
       floor = other->floorheight;
@@ -149,17 +144,12 @@ fixed_t P_FindLowestFloorSurrounding(sector_t __far* sec)
 fixed_t P_FindHighestFloorSurrounding(sector_t __far* sec)
 {
   int16_t i;
-  const line_t __far* check;
-  sector_t __far* other;
+  const sector_t __far* other;
   fixed_t floor = -32000*FRACUNIT;
 
-  for (i=0 ;i < sec->linecount ; i++)
+  for (i=0 ;i < sec->neighbourcount ; i++)
   {
-    check = sec->lines[i];
-    other = getNextSector(check,sec);
-
-    if (!other)
-      continue;
+    other = &_g_sectors[sec->neighbours[i]];
 
     if (other->floorheight > floor)
       floor = other->floorheight;
@@ -180,17 +170,15 @@ fixed_t P_FindHighestFloorSurrounding(sector_t __far* sec)
 //
 fixed_t P_FindNextLowestFloor(sector_t __far* sec, fixed_t currentheight)
 {
-  sector_t __far* other;
+  const sector_t __far* other;
   int16_t i;
 
-  for (i=0 ;i < sec->linecount ; i++)
-    if ((other = getNextSector(sec->lines[i],sec)) &&
-         other->floorheight < currentheight)
+  for (i=0 ;i < sec->neighbourcount ; i++)
+    if ((other = &_g_sectors[sec->neighbours[i]])->floorheight < currentheight)
     {
       fixed_t height = other->floorheight;
-      while (++i < sec->linecount)
-        if ((other = getNextSector(sec->lines[i],sec)) &&
-            other->floorheight > height &&
+      while (++i < sec->neighbourcount)
+        if ((other = &_g_sectors[sec->neighbours[i]])->floorheight > height &&
             other->floorheight < currentheight)
           height = other->floorheight;
       return height;
@@ -208,17 +196,12 @@ fixed_t P_FindNextLowestFloor(sector_t __far* sec, fixed_t currentheight)
 fixed_t P_FindLowestCeilingSurrounding(sector_t __far* sec)
 {
   int16_t                 i;
-  const line_t __far*             check;
-  sector_t __far*           other;
+  const sector_t __far*     other;
   fixed_t             height = 32000*FRACUNIT;
 
-  for (i=0 ;i < sec->linecount ; i++)
+  for (i=0 ;i < sec->neighbourcount ; i++)
   {
-    check = sec->lines[i];
-    other = getNextSector(check,sec);
-
-    if (!other)
-      continue;
+    other = &_g_sectors[sec->neighbours[i]];
 
     if (other->ceilingheight < height)
       height = other->ceilingheight;
@@ -236,17 +219,12 @@ fixed_t P_FindLowestCeilingSurrounding(sector_t __far* sec)
 fixed_t P_FindHighestCeilingSurrounding(sector_t __far* sec)
 {
   int16_t             i;
-  const line_t __far* check;
-  sector_t __far*       other;
+  const sector_t __far* other;
   fixed_t height = -32000*FRACUNIT;
 
-  for (i=0 ;i < sec->linecount ; i++)
+  for (i=0 ;i < sec->neighbourcount ; i++)
   {
-    check = sec->lines[i];
-    other = getNextSector(check,sec);
-
-    if (!other)
-      continue;
+    other = &_g_sectors[sec->neighbours[i]];
 
     if (other->ceilingheight > height)
       height = other->ceilingheight;
@@ -255,6 +233,106 @@ fixed_t P_FindHighestCeilingSurrounding(sector_t __far* sec)
 }
 
 
+//
+// Tag lists
+// The sectors and the lines with the same tag are chained
+// in ascending order, with the first of each tag in tagheads.
+//
+
+typedef struct
+{
+  int16_t tag;
+  int16_t firstsector;
+  int16_t firstline;
+} taghead_t;
+
+static taghead_t __far* tagheads;
+static int16_t numtagheads;
+static int16_t __far* sectortagnext;
+static int16_t __far* linetagnext;
+
+
+static taghead_t __far* P_FindTagHead(int16_t tag)
+{
+  for (int16_t i = 0; i < numtagheads; i++)
+  {
+    if (tagheads[i].tag == tag)
+      return &tagheads[i];
+  }
+
+  return NULL;
+}
+
+
+static taghead_t __far* P_AddTagHead(int16_t tag)
+{
+  taghead_t __far* head = P_FindTagHead(tag);
+  if (!head)
+  {
+    head = &tagheads[numtagheads++];
+    head->tag = tag;
+    head->firstsector = -1;
+    head->firstline   = -1;
+  }
+
+  return head;
+}
+
+
+static boolean P_HasTag(const int16_t __far* tags, int16_t count, int16_t tag)
+{
+  for (int16_t i = 0; i < count; i++)
+  {
+    if (tags[i] == tag)
+      return true;
+  }
+
+  return false;
+}
+
+
+void P_InitTagLists(void)
+{
+  sectortagnext = Z_MallocLevel(_g_numsectors * sizeof(int16_t), NULL);
+  linetagnext   = Z_MallocLevel(_g_numlines   * sizeof(int16_t), NULL);
+
+  // count the distinct tags first,
+  // collecting them in the chain links for now
+  int16_t numsectortags = 0;
+  for (int16_t i = 0; i < _g_numsectors; i++)
+  {
+    if (!P_HasTag(sectortagnext, numsectortags, _g_sectors[i].tag))
+      sectortagnext[numsectortags++] = _g_sectors[i].tag;
+  }
+
+  int16_t numlinetags = 0;
+  for (int16_t i = 0; i < _g_numlines; i++)
+  {
+    int16_t tag = _g_lines[i].tag;
+    if (!P_HasTag(sectortagnext, numsectortags, tag) && !P_HasTag(linetagnext, numlinetags, tag))
+      linetagnext[numlinetags++] = tag;
+  }
+
+  numtagheads = 0;
+  tagheads = Z_MallocLevel((numsectortags + numlinetags) * sizeof(taghead_t), NULL);
+
+  // walk backwards, so the chains are in ascending order
+  for (int16_t i = _g_numsectors - 1; i >= 0; i--)
+  {
+    taghead_t __far* head = P_AddTagHead(_g_sectors[i].tag);
+    sectortagnext[i] = head->firstsector;
+    head->firstsector = i;
+  }
+
+  for (int16_t i = _g_numlines - 1; i >= 0; i--)
+  {
+    taghead_t __far* head = P_AddTagHead(_g_lines[i].tag);
+    linetagnext[i] = head->firstline;
+    head->firstline = i;
+  }
+}
+
+
 //
 // RETURN NEXT SECTOR # THAT LINE TAG REFERS TO
 //
@@ -262,6 +340,15 @@ int16_t P_FindSectorFromLineTag(const line_t __far* line, int16_t start)
 {
     int16_t	i;
 
+    if (start < 0)
+    {
+        const taghead_t __far* head = P_FindTagHead(line->tag);
+        return head ? head->firstsector : -1;
+    }
+
+    if (_g_sectors[start].tag == line->tag)
+        return sectortagnext[start];
+
     for (i=start+1; i<_g_numsectors; i++)
     {
         if (_g_sectors[i].tag == line->tag)
@@ -272,6 +359,32 @@ int16_t P_FindSectorFromLineTag(const line_t __far* line, int16_t start)
 }
 
 
+//
+// RETURN NEXT LINE # THAT LINE TAG REFERS TO
+//
+int16_t P_FindLineFromLineTag(const line_t __far* line, int16_t start)
+{
+    int16_t	i;
+
+    if (start < 0)
+    {
+        const taghead_t __far* head = P_FindTagHead(line->tag);
+        return head ? head->firstline : -1;
+    }
+
+    if (_g_lines[start].tag == line->tag)
+        return linetagnext[start];
+
+    for (i=start+1; i<_g_numlines; i++)
+    {
+        if (_g_lines[i].tag == line->tag)
+            return i;
+    }
+
+    return -1;
+}
+
+
 //
 // P_CanUnlockGenDoor()
 //
@@ -732,11 +845,6 @@ void P_SpawnSpecials (void)
 //
 // This is the main scrolling code
 
-typedef struct {
-  thinker_t thinker;   // Thinker structure for scrolling
-  int16_t affectee;        // Number of affected sidedef, sector, tag, or whatever
-} scroll_t;
-
 static void T_Scroll(scroll_t __far* s)
 {
     side_t __far* side  =_g_sides + s->affectee;
@@ -763,7 +871,7 @@ static void T_Scroll(scroll_t __far* s)
 
 static void Add_Scroller(int16_t affectee)
 {
-  scroll_t __far* s = Z_CallocLevSpec(sizeof *s);
+  scroll_t __far* s = P_CallocThinker(TP_SCROLL);
   s->thinker.function = T_Scroll;
   s->affectee = affectee;
   P_AddThinker(&s->thinker);
@@ -513,6 +513,69 @@ typedef struct
 
 } floormove_t;
 
+typedef struct
+{
+  thinker_t thinker;
+  elevator_e type;
+  sector_t __far* sector;
+  int16_t direction;
+  fixed_t floordestheight;
+  fixed_t ceilingdestheight;
+  fixed_t speed;
+} elevator_t;
+
+// p_lights
+
+typedef struct
+{
+  thinker_t thinker;
+  sector_t __far* sector;
+  int16_t count;
+  int16_t maxlight;
+  int16_t minlight;
+
+} fireflicker_t;
+
+typedef struct
+{
+  thinker_t thinker;
+  sector_t __far* sector;
+  int16_t count;
+  int16_t maxlight;
+  int16_t minlight;
+  int16_t maxtime;
+  int16_t mintime;
+
+} lightflash_t;
+
+typedef struct
+{
+  thinker_t thinker;
+  sector_t __far* sector;
+  int16_t count;
+  int16_t minlight;
+  int16_t maxlight;
+  int16_t darktime;
+  int16_t brighttime;
+
+} strobe_t;
+
+typedef struct
+{
+  thinker_t thinker;
+  sector_t __far* sector;
+  int16_t minlight;
+  int16_t maxlight;
+  int16_t direction;
+} glow_t;
+
+// p_spec
+
+typedef struct {
+  thinker_t thinker;   // Thinker structure for scrolling
+  int16_t affectee;        // Number of affected sidedef, sector, tag, or whatever
+} scroll_t;
+
 
 ////////////////////////////////////////////////////////////////
 //
@@ -538,8 +601,12 @@ fixed_t P_FindHighestCeilingSurrounding(sector_t __far* sec);
 
 sector_t __far* P_FindModelFloorSector(fixed_t floordestheight, int16_t secnum);
 
+void P_InitTagLists(void);
+
 int16_t P_FindSectorFromLineTag(const line_t __far* line, int16_t start);
 
+int16_t P_FindLineFromLineTag(const line_t __far* line, int16_t start);
+
 sector_t __far* getNextSector(const line_t __far* line, sector_t __far* sec);
 
 boolean P_CheckTag(const line_t __far* line);
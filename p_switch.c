@@ -38,6 +38,7 @@
 #include "w_wad.h"
 #include "r_main.h"
 #include "p_spec.h"
+#include "p_tick.h"
 #include "g_game.h"
 #include "s_sound.h"
 #include "sounds.h"
@@ -364,7 +365,7 @@ static void EV_VerticalDoor(const line_t __far* line, mobj_t __far* thing)
   }
 
   // new door thinker
-  door = Z_CallocLevSpec(sizeof(*door));
+  door = P_CallocThinker(TP_MOVER);
   P_AddThinker (&door->thinker);
   sec->ceilingdata = door; //jff 2/22/98
   door->thinker.function = T_VerticalDoor;
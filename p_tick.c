@@ -33,11 +33,16 @@
  *
  *-----------------------------------------------------------------------------*/
 
+#include <stdint.h>
+
+#include "compiler.h"
 #include "d_player.h"
 #include "p_user.h"
 #include "p_spec.h"
 #include "p_tick.h"
 #include "p_map.h"
+#include "p_mobj.h"
+#include "z_bmallo.h"
 
 #include "globdata.h"
 
@@ -46,7 +51,12 @@ int32_t _g_leveltime; // tics in game play for par
 
 // killough 8/29/98: we maintain several separate threads, each containing
 // a special class of thinkers, to allow more efficient searches.
-thinker_t _g_thinkerclasscap;
+//
+// Things that think and the specials share TH_MAIN, because they
+// have to keep running in creation order to keep demos in sync.
+// Things that only cycle their states live in TH_ANIMATED,
+// things that never think live in TH_INERT.
+thinker_t _g_thinkerclasscap[NUMTHCLASSES];
 
 
 //
@@ -63,22 +73,78 @@ thinker_t _g_thinkerclasscap;
 // P_InitThinkers
 //
 
+// The sector movers share a pool, so P_RemoveThinkerDelayed
+// doesn't have to know what kind of mover it frees.
+typedef union
+{
+  vldoor_t    door;
+  ceiling_t   ceiling;
+  floormove_t floor;
+  plat_t      plat;
+  elevator_t  elevator;
+} mover_t;
+
+static struct block_memory_alloc_s thinkerpools[NUMTHINKERPOOLS];
+
 void P_InitThinkers(void)
 {
-  _g_thinkerclasscap.prev = _g_thinkerclasscap.next  = &_g_thinkerclasscap;
+  for (int16_t i = 0; i < NUMTHCLASSES; i++)
+    _g_thinkerclasscap[i].prev = _g_thinkerclasscap[i].next = &_g_thinkerclasscap[i];
+
+  // the pools were freed with the previous level
+  for (int16_t i = 0; i < NUMTHINKERPOOLS; i++)
+  {
+    thinkerpools[i].freelist = NULL;
+    thinkerpools[i].perpool  = 16;
+  }
+
+  thinkerpools[TP_MOVER].size       = sizeof(mover_t);
+  thinkerpools[TP_FIREFLICKER].size = sizeof(fireflicker_t);
+  thinkerpools[TP_LIGHTFLASH].size  = sizeof(lightflash_t);
+  thinkerpools[TP_STROBE].size      = sizeof(strobe_t);
+  thinkerpools[TP_GLOW].size        = sizeof(glow_t);
+  thinkerpools[TP_SCROLL].size      = sizeof(scroll_t);
+}
+
+
+//
+// P_CallocThinker
+// Allocates a special thinker from the pool of its type,
+// without a zone block header per thinker.
+//
+
+void __far* P_CallocThinker(thinkerpool_e pool)
+{
+  struct block_memory_alloc_s* zone = &thinkerpools[pool];
+
+  void __far* thinker = Z_BMalloc(zone);
+  _fmemset(thinker, 0, zone->size);
+  return thinker;
+}
+
+//
+// P_AddThinkerToClass
+// Adds a new thinker at the end of the list of its class.
+//
+
+void P_AddThinkerToClass(thinker_t __far* thinker, thinkerclass_e cls)
+{
+  thinker_t* cap = &_g_thinkerclasscap[cls];
+
+  cap->prev->next = thinker;
+  thinker->next = cap;
+  thinker->prev = cap->prev;
+  cap->prev = thinker;
 }
 
 //
 // P_AddThinker
-// Adds a new thinker at the end of the list.
+// Adds a new special at the end of the main list.
 //
 
 void P_AddThinker(thinker_t __far* thinker)
 {
-  _g_thinkerclasscap.prev->next = thinker;
-  thinker->next = &_g_thinkerclasscap;
-  thinker->prev = _g_thinkerclasscap.prev;
-  _g_thinkerclasscap.prev = thinker;
+  P_AddThinkerToClass(thinker, TH_MAIN);
 }
 
 //
@@ -109,7 +175,7 @@ static void P_RemoveThinkerDelayed(thinker_t __far* thinker)
          * thinker->prev->next = thinker->next */
     (next->prev = thinker->prev)->next = next;
 
-    Z_Free(thinker);
+    Z_BFree(&thinkerpools[TP_MOVER], thinker);
 }
 
 static void P_RemoveThingDelayed(thinker_t __far* thinker)
@@ -122,12 +188,7 @@ static void P_RemoveThingDelayed(thinker_t __far* thinker)
          * thinker->prev->next = thinker->next */
     (next->prev = thinker->prev)->next = next;
 
-    mobj_t __far* thing = (mobj_t __far*)thinker;
-
-    if(thing->flags & MF_POOLED)
-        thing->type = MT_NOTHING;
-    else
-        Z_Free(thinker);
+    P_FreeMobj((mobj_t __far*)thinker);
 }
 
 //
@@ -150,16 +211,27 @@ void P_RemoveThinker(thinker_t __far* thinker)
 
 void P_RemoveThing(mobj_t __far* thing)
 {
-  thing->thinker.function = P_RemoveThingDelayed;
+  thinker_t __far* thinker = &thing->thinker;
+
+  // TH_INERT is never run, so move the thing
+  // to a list that frees it on its next turn.
+  if (!thinker->function)
+  {
+    (thinker->next->prev = thinker->prev)->next = thinker->next;
+    P_AddThinkerToClass(thinker, TH_ANIMATED);
+  }
+
+  thinker->function = P_RemoveThingDelayed;
 }
 
 
 /* cph 2002/01/13 - iterator for thinker list
  * WARNING: Do not modify thinkers between calls to this function
+ * Walks TH_MAIN only, which holds every thing that fully thinks.
  */
 thinker_t __far* P_NextThinker(thinker_t __far* th)
 {
-  thinker_t* top = &_g_thinkerclasscap;
+  thinker_t* top = &_g_thinkerclasscap[TH_MAIN];
   if (!th) th = top;
   th = th->next;
   return th == top ? NULL : th;
@@ -191,8 +263,24 @@ thinker_t __far* P_NextThinker(thinker_t __far* th)
 
 static void P_RunThinkers (void)
 {
-    thinker_t __far* th = _g_thinkerclasscap.next;
-    thinker_t* th_end = &_g_thinkerclasscap;
+    thinker_t __far* th = _g_thinkerclasscap[TH_ANIMATED].next;
+    thinker_t* th_end = &_g_thinkerclasscap[TH_ANIMATED];
+
+    // Animated things don't interact with the rest,
+    // so they can run ahead of the main list.
+    while(th != th_end)
+    {
+        thinker_t __far* th_next = th->next;
+        if(th->function == P_MobjBrainlessThinker)
+            P_MobjBrainlessThinker((mobj_t __far*)th);
+        else if(th->function)
+            th->function(th);
+
+        th = th_next;
+    }
+
+    th = _g_thinkerclasscap[TH_MAIN].next;
+    th_end = &_g_thinkerclasscap[TH_MAIN];
 
     while(th != th_end)
     {
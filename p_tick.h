@@ -43,7 +43,31 @@
 
 void P_Ticker(void);
 
+// Special thinkers are allocated from a pool per type.
+// Only sector movers are removed during a level.
+typedef enum
+{
+  TP_MOVER,       // doors, ceilings, floors, plats and elevators
+  TP_FIREFLICKER,
+  TP_LIGHTFLASH,
+  TP_STROBE,
+  TP_GLOW,
+  TP_SCROLL,
+  NUMTHINKERPOOLS
+} thinkerpool_e;
+
+// Thinker lists, see p_tick.c
+typedef enum
+{
+  TH_MAIN,        // things that think and specials, in creation order
+  TH_ANIMATED,    // things that only cycle their states
+  TH_INERT,       // things that never think
+  NUMTHCLASSES
+} thinkerclass_e;
+
 void P_InitThinkers(void);
+void __far* P_CallocThinker(thinkerpool_e pool);
+void P_AddThinkerToClass(thinker_t __far* thinker, thinkerclass_e cls);
 void P_AddThinker(thinker_t __far* thinker);
 void P_RemoveThinker(thinker_t __far* thinker);
 void P_RemoveThing(mobj_t __far* thing);
@@ -88,7 +88,7 @@ typedef struct
 // Stores things/mobjs.
 //
 
-typedef struct
+typedef struct sector_s
 {
   fixed_t floorheight;
   fixed_t ceilingheight;
@@ -111,6 +111,11 @@ typedef struct
 
   int16_t linecount;
 
+  // the sectors across the lines, each one once, as sector numbers
+  int16_t __far* neighbours;
+
+  int16_t neighbourcount;
+
   int16_t floorpic;
   int16_t ceilingpic;
 
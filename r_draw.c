@@ -65,6 +65,19 @@ visplane_t __far* _g_freetail;
 static drawseg_t _s_drawsegs[MAXDRAWSEGS];
 
 
+//
+// Drawsegs that can clip sprites, bucketed by screen column range.
+// Each bucket is a bitset of drawseg indices,
+// so the drawsegs overlapping a sprite are found in drawseg order.
+//
+
+#define DRAWSEGBUCKETSHIFT	2
+#define NUMDRAWSEGBUCKETS	((VIEWWINDOWWIDTH + (1 << DRAWSEGBUCKETSHIFT) - 1) >> DRAWSEGBUCKETSHIFT)
+#define DRAWSEGWORDS		((MAXDRAWSEGS + 15) / 16)
+
+static uint16_t drawsegbuckets[NUMDRAWSEGBUCKETS][DRAWSEGWORDS];
+
+
 #define MAXOPENINGS (VIEWWINDOWWIDTH*16)
 
 static int16_t openings[MAXOPENINGS];
@@ -982,7 +995,7 @@ static void R_DrawVisSprite(const vissprite_t *vis)
     sprtopscreen = CENTERY * FRACUNIT - FixedMul(dcvars.texturemid, spryscale);
 
 
-    const patch_t __far* patch = W_GetLumpByNum(vis->lump_num);
+    const patch_t __far* patch = R_GetSpritePatch(vis->lump_num);
 
     dcvars.x = vis->x1;
 
@@ -998,8 +1011,6 @@ static void R_DrawVisSprite(const vissprite_t *vis)
 
         dcvars.x++;
     }
-
-    Z_ChangeTagToCache(patch);
 }
 
 
@@ -1148,6 +1159,28 @@ static PUREFUNC boolean R_PointOnSegSide(fixed_t x, fixed_t y, const seg_t __far
 }
 
 
+//
+// R_PrevDrawSeg
+// Returns the index of the last drawseg before dsnum in the bitset,
+// or -1 if there is none.
+//
+
+static int16_t R_PrevDrawSeg(const uint16_t* bitset, int16_t dsnum)
+{
+    while (--dsnum >= 0)
+    {
+        uint16_t bits = bitset[dsnum >> 4];
+
+        if (!bits)
+            dsnum &= ~15;   // skip the whole word
+        else if (bits & (1u << (dsnum & 15)))
+            return dsnum;
+    }
+
+    return -1;
+}
+
+
 //
 // R_DrawSprite
 //
@@ -1174,12 +1207,23 @@ static void R_DrawSprite (const vissprite_t* spr)
     // (pointer check was originally nonportable
     // and buggy, by going past LEFT end of array):
 
-    const drawseg_t* drawsegs  =_s_drawsegs;
+    // Only consider the drawsegs in the buckets the sprite overlaps.
+    uint16_t candidates[DRAWSEGWORDS];
+
+    memcpy(candidates, drawsegbuckets[spr->x1 >> DRAWSEGBUCKETSHIFT], sizeof(candidates));
+
+    for (int16_t b = (spr->x1 >> DRAWSEGBUCKETSHIFT) + 1; b <= (spr->x2 >> DRAWSEGBUCKETSHIFT); b++)
+    {
+        for (int16_t w = 0; w < DRAWSEGWORDS; w++)
+            candidates[w] |= drawsegbuckets[b][w];
+    }
 
-    for (const drawseg_t* ds = ds_p; ds-- > drawsegs; )  // new -- killough
+    for (int16_t dsnum = ds_p - _s_drawsegs; (dsnum = R_PrevDrawSeg(candidates, dsnum)) >= 0; )
     {
+        const drawseg_t* ds = &_s_drawsegs[dsnum];
+
         // determine if the drawseg obscures the sprite
-        if (ds->x1 > spr->x2 || ds->x2 < spr->x1 || (!ds->silhouette && !ds->maskedtexturecol))
+        if (ds->x1 > spr->x2 || ds->x2 < spr->x1)
             continue;      // does not cover sprite
 
         const int16_t r1 = ds->x1 < spr->x1 ? spr->x1 : ds->x1;
@@ -1259,7 +1303,7 @@ static void R_DrawPSprite (pspdef_t *psp, int16_t lightlevel)
 
     flip = (boolean) SPR_FLIPPED(sprframe, 0);
 
-    const patch_t __far* patch = W_GetLumpByNum(sprframe->lump[0]);
+    const patch_t __far* patch = R_GetSpritePatch(sprframe->lump[0]);
     // calculate edges of the shape
     fixed_t tx = psp->sx - (SCREENWIDTH_VGA / 2) * FRACUNIT;
 
@@ -1275,10 +1319,7 @@ static void R_DrawPSprite (pspdef_t *psp, int16_t lightlevel)
 
     // off the side
     if (x2 < 0 || x1 > VIEWWINDOWWIDTH)
-    {
-        Z_ChangeTagToCache(patch);
         return;
-    }
 
     // store information in a vissprite
     vis = &avis;
@@ -1307,7 +1348,6 @@ static void R_DrawPSprite (pspdef_t *psp, int16_t lightlevel)
 
     vis->lump_num        = sprframe->lump[0];
     vis->patch_topoffset = patch->topoffset;
-    Z_ChangeTagToCache(patch);
 
     if (_g_player.powers[pw_invisibility] > 4*32 || _g_player.powers[pw_invisibility] & 8)
         vis->colormap = NULL;                    // shadow draw
@@ -1344,39 +1384,106 @@ static void R_DrawPlayerSprites(void)
 }
 
 
+#define MAXVISSPRITES 96
+static int8_t num_vissprite;
+static vissprite_t vissprites[MAXVISSPRITES];
+static vissprite_t* vissprite_ptrs[MAXVISSPRITES];
+
+
 //
 // R_SortVisSprites
 //
-static int compare (const void* l, const void* r)
+// Sorts vissprite_ptrs from the largest to the smallest scale.
+// Small counts get an insertion sort.
+// Crowded frames are first distributed over buckets by the highest bits of the scale,
+// leaving only a few sprites for the final insertion sort to move.
+//
+
+#define VISSPRITE_INSERTIONSORT_MAX 16
+#define VISSPRITE_BUCKETS 62
+
+//
+// 2 * (position of the highest set bit) + the bit below it,
+// so buckets are ordered like the scales they hold.
+//
+static uint8_t R_VisSpriteBucket(fixed_t scale)
 {
-	const vissprite_t* vl = *(const vissprite_t**)l;
-	const vissprite_t* vr = *(const vissprite_t**)r;
+    if (scale <= 0)
+        return 0;
 
-	fixed_t diff = vr->scale - vl->scale;
-	if (!diff)
-		return 0;
-	else if (diff < 0)
-		return -1;
-	else
-		return 1;
+    uint32_t s = scale;
+    int8_t msb = 30;
+
+    if (!(s & 0x7fff8000)) { s <<= 16; msb -= 16; }
+    if (!(s & 0x7f800000)) { s <<=  8; msb -=  8; }
+    if (!(s & 0x78000000)) { s <<=  4; msb -=  4; }
+    if (!(s & 0x60000000)) { s <<=  2; msb -=  2; }
+    if (!(s & 0x40000000)) { s <<=  1; msb -=  1; }
+
+    return 2 * msb + ((s >> 29) & 1);
 }
 
-#define MAXVISSPRITES 96
-static int8_t num_vissprite;
-static vissprite_t vissprites[MAXVISSPRITES];
-static vissprite_t* vissprite_ptrs[MAXVISSPRITES];
 
-static void R_SortVisSprites (void)
+static void R_InsertionSortVisSprites(void)
 {
-    int8_t i = num_vissprite;
+    for (int8_t i = 1; i < num_vissprite; i++)
+    {
+        vissprite_t* v = vissprite_ptrs[i];
+        const fixed_t scale = v->scale;
+
+        int8_t j = i;
+        while (j > 0 && vissprite_ptrs[j - 1]->scale < scale)
+        {
+            vissprite_ptrs[j] = vissprite_ptrs[j - 1];
+            j--;
+        }
+
+        vissprite_ptrs[j] = v;
+    }
+}
+
 
-    if (i)
+static void R_BucketSortVisSprites(void)
+{
+    uint8_t buckets[VISSPRITE_BUCKETS];
+    uint8_t keys[MAXVISSPRITES];
+
+    memset(buckets, 0, sizeof(buckets));
+
+    for (int8_t i = 0; i < num_vissprite; i++)
+    {
+        keys[i] = (VISSPRITE_BUCKETS - 1) - R_VisSpriteBucket(vissprites[i].scale);
+        buckets[keys[i]]++;
+    }
+
+    // bucket counts to start positions
+    uint8_t start = 0;
+    for (int8_t b = 0; b < VISSPRITE_BUCKETS; b++)
     {
-        while (--i >= 0)
+        uint8_t count = buckets[b];
+        buckets[b] = start;
+        start += count;
+    }
+
+    for (int8_t i = 0; i < num_vissprite; i++)
+        vissprite_ptrs[buckets[keys[i]]++] = vissprites + i;
+
+    // buckets are in order, only sprites within a bucket can still be out of order
+    R_InsertionSortVisSprites();
+}
+
+
+static void R_SortVisSprites (void)
+{
+    if (num_vissprite <= VISSPRITE_INSERTIONSORT_MAX)
+    {
+        for (int8_t i = 0; i < num_vissprite; i++)
             vissprite_ptrs[i] = vissprites + i;
 
-        qsort(vissprite_ptrs, num_vissprite, sizeof (vissprite_t*), compare);
+        R_InsertionSortVisSprites();
     }
+    else
+        R_BucketSortVisSprites();
 }
 
 //
@@ -1430,6 +1537,7 @@ static vissprite_t *R_NewVisSprite(void)
 static void R_ClearSprites(void)
 {
     num_vissprite = 0;
+    R_AgeSpriteCache();
 }
 
 
@@ -1505,7 +1613,7 @@ static void R_ProjectSprite (mobj_t __far* thing, int16_t lightlevel)
     }
 
     const boolean flip = (boolean)SPR_FLIPPED(sprframe, rot);
-    const patch_t __far* patch = W_GetLumpByNum(sprframe->lump[rot]);
+    const patch_t __far* patch = R_GetSpritePatch(sprframe->lump[rot]);
 
     /* calculate edges of the shape
      * cph 2003/08/1 - fraggle points out that this offset must be flipped
@@ -1523,27 +1631,18 @@ static void R_ProjectSprite (mobj_t __far* thing, int16_t lightlevel)
 
     // off the side?
     if (x1 > VIEWWINDOWWIDTH)
-    {
-        Z_ChangeTagToCache(patch);
         return;
-    }
 
     fixed_t xr = CENTERX * FRACUNIT + FixedMul(tx + (((int32_t)patch->width) << FRACBITS), xscale) - FRACUNIT;
     const int16_t x2 = (xr >> FRACBITS);
 
     // off the side?
     if (xr < 0)
-    {
-        Z_ChangeTagToCache(patch);
         return;
-    }
 
     //Too small.
     if (xr <= (xl + (FRACUNIT >> 2)))
-    {
-        Z_ChangeTagToCache(patch);
         return;
-    }
 
 
     // store information in a vissprite
@@ -1551,10 +1650,7 @@ static void R_ProjectSprite (mobj_t __far* thing, int16_t lightlevel)
 
     //No more vissprites.
     if(!vis)
-    {
-        Z_ChangeTagToCache(patch);
         return;
-    }
 
     //vis->scale           = FixedDiv(PROJECTIONY, tz);
     vis->scale           = (VIEWWINDOWHEIGHT * FRACUNIT) / (tz >> FRACBITS);
@@ -1582,8 +1678,6 @@ static void R_ProjectSprite (mobj_t __far* thing, int16_t lightlevel)
         vis->xiscale = iscale;
     }
 
-    Z_ChangeTagToCache(patch);
-
     if (vis->x1 > x1)
         vis->startfrac += vis->xiscale*(vis->x1-x1);
 
@@ -1598,6 +1692,8 @@ static void R_ProjectSprite (mobj_t __far* thing, int16_t lightlevel)
     {      // diminished light
         vis->colormap = R_ColourMap(lightlevel);
     }
+
+    R_PrefetchSpriteFrame(thing, rot);
 }
 
 //
@@ -2473,6 +2569,16 @@ static void R_StoreWallRange(const int8_t start, const int8_t stop)
         ds_p->bsilheight = INT32_MAX;
     }
 
+    // index the drawseg for sprite clipping
+    if (ds_p->silhouette || ds_p->maskedtexturecol)
+    {
+        const int16_t dsnum = ds_p - _s_drawsegs;
+        const uint16_t mask = 1u << (dsnum & 15);
+
+        for (int16_t b = start >> DRAWSEGBUCKETSHIFT; b <= (stop >> DRAWSEGBUCKETSHIFT); b++)
+            drawsegbuckets[b][dsnum >> 4] |= mask;
+    }
+
     ds_p++;
 }
 
@@ -2916,6 +3022,7 @@ static void R_RenderBSPNode(int16_t bspnum)
 static void R_ClearDrawSegs(void)
 {
     ds_p = _s_drawsegs;
+    memset(drawsegbuckets, 0, sizeof(drawsegbuckets));
 }
 
 static void R_ClearClipSegs (void)
@@ -26,6 +26,9 @@
 #include "r_defs.h"
 #include "r_main.h"
 #include "w_wad.h"
+#include "i_system.h"
+
+#include "globdata.h"
 
 
 #define FLAT_SKY_COLOR 100
@@ -54,47 +57,176 @@ static void R_DrawSkyFlat(visplane_t __far* pl)
 
 #define ANGLETOSKYSHIFT         22
 
-void R_DrawSky(visplane_t __far* pl)
+#if !defined FLAT_SKY
+//
+// Sky column cache
+//
+// The sky is drawn full bright at a fixed scale,
+// so a texture column always ends up as the same pixels on screen.
+// Those pixels are kept in a strip of pre-scaled columns,
+// and drawn with a straight copy.
+// The strip is a cachable zone block between calls,
+// so it's dropped when memory runs low.
+//
+
+#define SKYCACHE_COLUMNS	64	// more than VIEWWINDOWWIDTH, so R_DrawSky never evicts its own columns
+#define SKYCACHE_EMPTY		0xff
+#define MAXSKYWIDTH			256
+
+static byte __far* skyColumnCache;	// NULL after it's been purged
+static int16_t skyColumnCacheEntries[SKYCACHE_COLUMNS];	// texture column per cache column
+static uint16_t skyColumnCacheDraws[SKYCACHE_COLUMNS];	// R_DrawSky call that last drew the cache column
+static uint8_t skyColumnCacheIndex[MAXSKYWIDTH];		// cache column per texture column
+static uint8_t skyColumnCacheHand;
+static uint16_t skydrawcount;
+static const lighttable_t __far* skyColumnCacheColormap;
+
+
+static void R_ClearSkyColumnCache(void)
 {
-#if defined FLAT_SKY
-	R_DrawSkyFlat(pl);
-#else
+	memset(skyColumnCacheIndex, SKYCACHE_EMPTY, sizeof(skyColumnCacheIndex));
 
-	const patch_t __far* patch = W_TryGetLumpByNum(skypatchnum);
-	if (patch == NULL)
+	for (int16_t i = 0; i < SKYCACHE_COLUMNS; i++)
 	{
-		R_DrawSkyFlat(pl);
-		return;
+		skyColumnCacheEntries[i] = -1;
+		skyColumnCacheDraws[i]  = skydrawcount - 1;
 	}
+}
 
-	// Normal Doom sky, only one allowed per level
-	draw_column_vars_t dcvars;
-	dcvars.texturemid = 100 * FRACUNIT;    // Default y-offset
+
+static uint8_t R_FindFreeSkyColumn(void)
+{
+	// skip the cache columns that are already used by this call
+	while (skyColumnCacheDraws[skyColumnCacheHand] == skydrawcount)
+		skyColumnCacheHand = (skyColumnCacheHand + 1) & (SKYCACHE_COLUMNS - 1);
+
+	uint8_t i = skyColumnCacheHand;
+	skyColumnCacheHand = (skyColumnCacheHand + 1) & (SKYCACHE_COLUMNS - 1);
+
+	if (skyColumnCacheEntries[i] != -1)
+		skyColumnCacheIndex[skyColumnCacheEntries[i]] = SKYCACHE_EMPTY;
+
+	return i;
+}
+
+
+//
+// Scale a sky texture column to the full height of the view window,
+// exactly like R_DrawColumn would.
+//
+static void R_BuildSkyColumn(byte __far* dest, const byte __far* source, const lighttable_t __far* colormap, fixed_t texturemid, fixed_t iscale)
+{
+	fixed_t frac = texturemid - (VIEWWINDOWHEIGHT / 2) * iscale;
+
+	for (int16_t y = 0; y < VIEWWINDOWHEIGHT; y++)
+	{
+		*dest++ = colormap[source[(frac >> FRACBITS) & 127]];
+		frac += iscale;
+	}
+}
+
+
+static void R_DrawSkyColumn(int16_t x, int16_t yl, int16_t yh, const byte __far* source)
+{
+	int16_t count = (yh - yl) + 1;
+
+	uint16_t __far* d = (uint16_t __far*)(_g_screen + (yl * SCREENWIDTH) + (x << 2));
+	source += yl;
+
+	while (count--)
+	{
+		uint16_t color = *source++;
+		color = (color | (color << 8));
+		*d++ = color;
+		*d   = color;
+		d += (SCREENWIDTH / 2) - 1;
+	}
+}
+#endif
+
+
+void R_DrawSky(visplane_t __far* pl)
+{
+#if defined FLAT_SKY
+	R_DrawSkyFlat(pl);
+#else
 
 	// Sky is always drawn full bright, i.e. colormaps[0] is used.
 	// Because of this hack, sky is not affected by INVUL inverse mapping.
 	// Until Boom fixed this.
 
-	if (!(dcvars.colormap = fixedcolormap))
-		dcvars.colormap = fullcolormap;
+	const lighttable_t __far* colormap = fixedcolormap;
+	if (!colormap)
+		colormap = fullcolormap;
 
-	dcvars.iscale = (FRACUNIT * 200) / (VIEWWINDOWHEIGHT + 16);
+	if (skyColumnCache)
+		Z_ChangeTagToStatic(skyColumnCache);
+	else
+	{
+		if (!Z_IsEnoughFreeMemory(SKYCACHE_COLUMNS * VIEWWINDOWHEIGHT))
+		{
+			R_DrawSkyFlat(pl);
+			return;
+		}
+
+		skyColumnCache = Z_MallocStaticWithUser(SKYCACHE_COLUMNS * VIEWWINDOWHEIGHT, (void __far*__far*)&skyColumnCache);
+		skyColumnCacheColormap = NULL;
+	}
 
-	for (int16_t x = pl->minx; (dcvars.x = x) <= pl->maxx; x++)
+	if (colormap != skyColumnCacheColormap)
 	{
-		if ((dcvars.yl = pl->top[x]) != -1 && dcvars.yl <= (dcvars.yh = pl->bottom[x])) // dropoff overflow
+		R_ClearSkyColumnCache();
+		skyColumnCacheColormap = colormap;
+	}
+
+	static const fixed_t texturemid = 100 * FRACUNIT;    // Default y-offset
+	static const fixed_t iscale     = (FRACUNIT * 200) / (VIEWWINDOWHEIGHT + 16);
+
+	// Normal Doom sky, only one allowed per level
+	const patch_t __far* patch = NULL;
+
+	for (int16_t x = pl->minx; x <= pl->maxx; x++)
+	{
+		int16_t yl = pl->top[x];
+		int16_t yh;
+		if (yl != -1 && yl <= (yh = pl->bottom[x])) // dropoff overflow
 		{
 			int16_t xc = (viewangle + xtoviewangle(x)) >> ANGLETOSKYSHIFT;
 			int16_t x_c = xc & skywidthmask;
 
-			const column_t __far* column = (const column_t __far*) ((const byte __far*)patch + patch->columnofs[x_c]);
-
-			dcvars.source = (const byte __far*)column + 3;
-			R_DrawColumn(&dcvars);
+			uint8_t i = skyColumnCacheIndex[x_c];
+			if (i == SKYCACHE_EMPTY)
+			{
+				if (patch == NULL)
+				{
+					patch = W_TryGetLumpByNum(skypatchnum);
+					if (patch == NULL)
+					{
+						Z_ChangeTagToCache(skyColumnCache);
+						R_DrawSkyFlat(pl);
+						return;
+					}
+				}
+
+				const column_t __far* column = (const column_t __far*) ((const byte __far*)patch + patch->columnofs[x_c]);
+
+				i = R_FindFreeSkyColumn();
+				R_BuildSkyColumn(&skyColumnCache[i * VIEWWINDOWHEIGHT], (const byte __far*)column + 3, colormap, texturemid, iscale);
+				skyColumnCacheEntries[i] = x_c;
+				skyColumnCacheIndex[x_c] = i;
+			}
+
+			skyColumnCacheDraws[i] = skydrawcount;
+			R_DrawSkyColumn(x, yl, yh, &skyColumnCache[i * VIEWWINDOWHEIGHT]);
 		}
 	}
 
-	Z_ChangeTagToCache(patch);
+	if (patch != NULL)
+		Z_ChangeTagToCache(patch);
+
+	Z_ChangeTagToCache(skyColumnCache);
+
+	skydrawcount++;
 #endif
 }
 
@@ -112,4 +244,11 @@ void R_InitSky(void)
 	//  we look for an actual index, instead of simply
 	//  setting one.
 	skyflatnum = R_FlatNumForName("F_SKY1");
+
+#if !defined FLAT_SKY
+	if (skywidthmask >= MAXSKYWIDTH)
+		I_Error("R_InitSky: sky texture is wider than %i", MAXSKYWIDTH);
+
+	skyColumnCacheColormap = NULL;
+#endif
 }
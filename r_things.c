@@ -249,10 +249,199 @@ void R_InitSprites(void)
 }
 
 
+//
+// Sprite frame cache
+//
+// Sprite lumps are released to PU_CACHE right after drawing,
+// so the zone rover can purge them one allocation later.
+// The frames of things that are on screen are kept static instead,
+// within a budget, and released to PU_CACHE again when they haven't
+// been drawn for a while, oldest first.
+//
+
+#define SPRITECACHE_ENTRIES	32
+#define SPRITECACHE_BUDGET	(16 * 1024L)
+#define SPRITECACHE_RETAIN	(2 * TICRATE)
+
+typedef struct
+{
+  int16_t lump;     // -1 if unused
+  int32_t lasttic;  // tic the frame was last drawn or prefetched
+} spritecache_t;
+
+static spritecache_t spritecache[SPRITECACHE_ENTRIES];
+static uint16_t spritecachesize;
+
+
+static void R_UnpinSprite(spritecache_t* entry)
+{
+  // The lump might have been released and purged behind our back,
+  // so don't keep a pointer around.
+  if (W_IsLumpCached(entry->lump))
+    Z_ChangeTagToCache(W_GetLumpByNum(entry->lump));
+
+  spritecachesize -= W_LumpLength(entry->lump);
+  entry->lump = -1;
+}
+
+
+//
+// R_ClearSpriteCache
+// Also the purge hook of the zone, for when it runs out of memory.
+// Returns true if any frames were released.
+//
+boolean R_ClearSpriteCache(void)
+{
+  boolean released = false;
+
+  for (int8_t i = 0; i < SPRITECACHE_ENTRIES; i++)
+  {
+    if (spritecache[i].lump != -1)
+    {
+      R_UnpinSprite(&spritecache[i]);
+      released = true;
+    }
+  }
+
+  return released;
+}
+
+
+//
+// R_AgeSpriteCache
+// Called at frame start.
+//
+void R_AgeSpriteCache(void)
+{
+  for (int8_t i = 0; i < SPRITECACHE_ENTRIES; i++)
+  {
+    if (spritecache[i].lump != -1 && _g_gametic - spritecache[i].lasttic > SPRITECACHE_RETAIN)
+      R_UnpinSprite(&spritecache[i]);
+  }
+}
+
+
+static spritecache_t* R_FindSpriteCacheEntry(int16_t lump)
+{
+  for (int8_t i = 0; i < SPRITECACHE_ENTRIES; i++)
+  {
+    if (spritecache[i].lump == lump)
+      return &spritecache[i];
+  }
+
+  return NULL;
+}
+
+
+//
+// R_PinSprite
+// Keeps a freshly loaded, static, sprite lump static,
+// evicting the least recently drawn frames if needed.
+//
+static void R_PinSprite(int16_t lump, const patch_t __far* patch)
+{
+  const uint16_t size = W_LumpLength(lump);
+
+  if (size > SPRITECACHE_BUDGET)
+  {
+    Z_ChangeTagToCache(patch);
+    return;
+  }
+
+  spritecache_t* slot;
+
+  while (true)
+  {
+    slot = NULL;
+    spritecache_t* oldest = NULL;
+
+    for (int8_t i = 0; i < SPRITECACHE_ENTRIES; i++)
+    {
+      spritecache_t* entry = &spritecache[i];
+
+      if (entry->lump == -1)
+        slot = entry;
+      else if (!oldest || entry->lasttic < oldest->lasttic)
+        oldest = entry;
+    }
+
+    if (slot && spritecachesize + size <= SPRITECACHE_BUDGET)
+      break;
+
+    R_UnpinSprite(oldest);
+  }
+
+  slot->lump    = lump;
+  slot->lasttic = _g_gametic;
+  spritecachesize += size;
+}
+
+
+//
+// R_GetSpritePatch
+// Returns a sprite lump, and keeps it static for as long as it's being drawn.
+// Don't change the tag of the returned patch.
+//
+const patch_t __far* R_GetSpritePatch(int16_t lump)
+{
+  spritecache_t* entry = R_FindSpriteCacheEntry(lump);
+
+  const patch_t __far* patch = W_GetLumpByNum(lump);
+
+  if (entry)
+    entry->lasttic = _g_gametic;
+  else
+    R_PinSprite(lump, patch);
+
+  return patch;
+}
+
+
+//
+// R_PrefetchSpriteFrame
+// Keeps the sprite lump of a thing's next state,
+// or queues it for read-ahead,
+// so it's resident by the time the thing changes frames.
+//
+void R_PrefetchSpriteFrame(const mobj_t __far* thing, uint16_t rot)
+{
+  const state_t* state = thing->state;
+
+  if (state->tics == -1 || state->nextstate == S_NULL)
+    return;
+
+  const state_t* next = &states[state->nextstate];
+
+  if (next->sprite == thing->sprite && ((next->frame ^ thing->frame) & FF_FRAMEMASK) == 0)
+    return;
+
+  const spriteframe_t __far* sprframe = &sprites[next->sprite].spriteframes[next->frame & FF_FRAMEMASK];
+  const int16_t lump = sprframe->lump[sprframe->rotate ? rot : 0];
+
+  spritecache_t* entry = R_FindSpriteCacheEntry(lump);
+  if (entry)
+  {
+    entry->lasttic = _g_gametic;
+    return;
+  }
+
+  if (W_IsLumpCached(lump))
+    R_PinSprite(lump, W_GetLumpByNum(lump));
+  else
+    W_ReadAhead(lump); // don't hit the disk in the middle of a frame
+}
+
+
 void R_InitSpriteLumps(void)
 {
 	firstspritelump        = W_GetNumForName("S_START") + 1;
 	int16_t lastspritelump = W_GetNumForName("S_END")   - 1;
 
 	numentries = lastspritelump - firstspritelump + 1;
+
+	for (int8_t i = 0; i < SPRITECACHE_ENTRIES; i++)
+		spritecache[i].lump = -1;
+
+	Z_SetPurgeHook(R_ClearSpriteCache);
 }
+
@@ -36,7 +36,14 @@
 #ifndef __R_THINGS__
 #define __R_THINGS__
 
+#include "r_defs.h"
+
 void R_InitSprites(void);
 void R_InitSpriteLumps(void);
 
+boolean R_ClearSpriteCache(void);
+void R_AgeSpriteCache(void);
+const patch_t __far* R_GetSpritePatch(int16_t lump);
+void R_PrefetchSpriteFrame(const mobj_t __far* thing, uint16_t rot);
+
 #endif
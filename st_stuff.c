@@ -57,6 +57,16 @@
 // Typedefs of widgets
 //
 
+// Screen area covered by a widget
+typedef struct
+{
+  int16_t   x;
+  int16_t   y;
+  int16_t   w;
+  int16_t   h;
+} st_rect_t;
+
+
 // Number widget
 
 typedef struct
@@ -78,6 +88,9 @@ typedef struct
   // list of patches for 0-9
   int16_t* p;
 
+  // area of the last drawn digits
+  st_rect_t rect;
+
 } st_number_t;
 
 
@@ -97,6 +110,9 @@ typedef struct
   // list of icons
   int16_t*   p;
 
+  // area of the last drawn icon
+  st_rect_t  rect;
+
 } st_multicon_t;
 
 
@@ -605,6 +621,103 @@ static void ST_doPaletteStuff(void)
 }
 
 
+//
+// ST_addRect()
+//
+// Grows a widget area so that it covers the patch drawn at x, y.
+// Clipped to the status bar, as that's all the presentation layer
+// blits on its own.
+//
+static void ST_addRect(st_rect_t* r, int16_t x, int16_t y, const patch_t __far* patch)
+{
+    int16_t x1 = x - patch->leftoffset;
+    int16_t y1 = y - patch->topoffset;
+    int16_t x2 = x1 + patch->width;
+    int16_t y2 = y1 + patch->height;
+
+    if (x1 < 0)
+        x1 = 0;
+    if (y1 < ST_Y)
+        y1 = ST_Y;
+    if (x2 > (int16_t)SCREENWIDTH)
+        x2 = SCREENWIDTH;
+    if (y2 > SCREENHEIGHT)
+        y2 = SCREENHEIGHT;
+
+    if (x1 >= x2 || y1 >= y2)
+        return;
+
+    if (r->w)
+    {
+        x1 = MIN(x1, r->x);
+        y1 = MIN(y1, r->y);
+        x2 = MAX(x2, r->x + r->w);
+        y2 = MAX(y2, r->y + r->h);
+    }
+
+    r->x = x1;
+    r->y = y1;
+    r->w = x2 - x1;
+    r->h = y2 - y1;
+}
+
+
+static void ST_drawPatch(st_rect_t* r, int16_t x, int16_t y, int16_t num)
+{
+    const patch_t __far* patch = W_GetLumpByNum(num);
+    V_DrawPatchNotScaled(x, y, patch);
+    ST_addRect(r, x, y, patch);
+    Z_ChangeTagToCache(patch);
+}
+
+
+//
+// ST_eraseRect()
+//
+// Restores the status bar background under a widget
+//
+static void ST_eraseRect(const st_rect_t* r, const uint8_t __far* stbar)
+{
+    if (!r->w)
+        return;
+
+    byte __far* dest = _g_screen + (r->y * SCREENWIDTH) + r->x;
+    const byte __far* src = stbar + ((r->y - ST_Y) * SCREENWIDTH) + r->x;
+
+    for (int16_t y = 0; y < r->h; y++)
+    {
+        _fmemcpy(dest, src, r->w);
+        dest += SCREENWIDTH;
+        src  += SCREENWIDTH;
+    }
+}
+
+
+//
+// ST_reportRect()
+//
+// Reports the area covered by both the erased and the newly drawn patches
+// of a widget to the presentation layer.
+//
+static void ST_reportRect(const st_rect_t* o, const st_rect_t* n)
+{
+    if (!o->w)
+        o = n;
+    else if (!n->w)
+        n = o;
+
+    if (!o->w)
+        return;
+
+    int16_t x1 = MIN(o->x, n->x);
+    int16_t y1 = MIN(o->y, n->y);
+    int16_t x2 = MAX(o->x + o->w, n->x + n->w);
+    int16_t y2 = MAX(o->y + o->h, n->y + n->h);
+
+    I_AddStatusBarRect(x1, y1, x2 - x1, y2 - y1);
+}
+
+
 //
 // STlib_updateMultIcon()
 //
@@ -620,8 +733,10 @@ static void STlib_updateMultIcon(st_multicon_t* mi)
     if(!mi->p)
         return;
 
+    mi->rect.w = 0;
+
     if (*mi->inum != -1)  // killough 2/16/98: redraw only if != -1
-		V_DrawNumPatchNotScaled(mi->x, mi->y, mi->p[*mi->inum]);
+		ST_drawPatch(&mi->rect, mi->x, mi->y, mi->p[*mi->inum]);
 
     mi->oldinum = *mi->inum;
 
@@ -661,7 +776,7 @@ static void STlib_drawNum(st_number_t* n)
   }
 
   // clear the area
-  x = n->x - numdigits*w;
+  n->rect.w = 0;
 
   // if non-number, do not draw it
   if (num == largeammo)
@@ -671,18 +786,50 @@ static void STlib_drawNum(st_number_t* n)
 
   // in the special case of 0, you draw 0
   if (!num)
-    V_DrawNumPatchNotScaled(x - w, n->y, n->p[0]);
+    ST_drawPatch(&n->rect, x - w, n->y, n->p[0]);
 
   // draw the new number
   while (num && numdigits--)
   {
     x -= w;
-    V_DrawNumPatchNotScaled(x, n->y, n->p[num % 10]);
+    ST_drawPatch(&n->rect, x, n->y, n->p[num % 10]);
     num /= 10;
   }
 }
 
 
+//
+// STlib_updateNum()
+//
+// Redraws a number widget only if its value changed,
+// reporting both the old and the new digits as changed.
+//
+static void STlib_updateNum(st_number_t* n, const uint8_t __far* stbar)
+{
+    if (n->oldnum == *n->num)
+        return;
+
+    const st_rect_t old = n->rect;
+
+    ST_eraseRect(&old, stbar);
+    STlib_drawNum(n);
+    ST_reportRect(&old, &n->rect);
+}
+
+
+static void STlib_updateChangedMultIcon(st_multicon_t* mi, const uint8_t __far* stbar)
+{
+    if (mi->oldinum == *mi->inum)
+        return;
+
+    const st_rect_t old = mi->rect;
+
+    ST_eraseRect(&old, stbar);
+    STlib_updateMultIcon(mi);
+    ST_reportRect(&old, &mi->rect);
+}
+
+
 static void ST_drawWidgets(void)
 {
     STlib_drawNum(&w_ready);
@@ -725,70 +872,112 @@ static void ST_doRefresh(void)
 #endif
 }
 
-static boolean ST_NeedUpdate()
+//
+// ST_updateChangedWidgets()
+//
+// Redraws only the widgets whose value changed since they were last drawn.
+// Everything else on the status bar is left untouched in the back buffer
+// and on the screen.
+//
+static void ST_updateChangedWidgets(const uint8_t __far* stbar)
 {
-	// ready weapon ammo
-	if(w_ready.oldnum != *w_ready.num)
-        return true;
-	
-    if(st_health.oldnum != *st_health.num)
-        return true;
+    STlib_updateNum(&w_ready, stbar);
+
+    for (int8_t i = 0; i < 4; i++)
+    {
+        STlib_updateNum(&w_ammo[i], stbar);
+        STlib_updateNum(&w_maxammo[i], stbar);
+    }
+
+    STlib_updateNum(&st_health, stbar);
+    STlib_updateNum(&st_armor,  stbar);
+
+    STlib_updateChangedMultIcon(&w_faces, stbar);
+
+    for (int8_t i = 0; i < 3; i++)
+        STlib_updateChangedMultIcon(&w_keyboxes[i], stbar);
+
+    for (int8_t i = 0; i < 6; i++)
+        STlib_updateChangedMultIcon(&w_arms[i], stbar);
+}
 
-    if(st_armor.oldnum != *st_armor.num)
-        return true;
 
-    if(w_faces.oldinum != *w_faces.inum)
+//
+// ST_widgetsChanged()
+//
+// Returns true if ST_updateChangedWidgets has anything to redraw.
+//
+static boolean ST_widgetsChanged(void)
+{
+    if (w_ready.oldnum != *w_ready.num
+     || st_health.oldnum != *st_health.num
+     || st_armor.oldnum  != *st_armor.num
+     || w_faces.oldinum  != *w_faces.inum)
         return true;
-	
-	// ammo
-    for(int8_t i=0; i<4; i++)
+
+    for (int8_t i = 0; i < 4; i++)
     {
-        if(w_ammo[i].oldnum != *w_ammo[i].num)
-            return true;
-		if(w_maxammo[i].oldnum != *w_maxammo[i].num)
+        if (w_ammo[i].oldnum != *w_ammo[i].num || w_maxammo[i].oldnum != *w_maxammo[i].num)
             return true;
     }
 
-    // weapons owned
-    for(int8_t i=0; i<6; i++)
+    for (int8_t i = 0; i < 3; i++)
     {
-        if(w_arms[i].oldinum != *w_arms[i].inum)
+        if (w_keyboxes[i].oldinum != *w_keyboxes[i].inum)
             return true;
     }
 
-    for(int8_t i = 0; i < 3; i++)
+    for (int8_t i = 0; i < 6; i++)
     {
-        if(w_keyboxes[i].oldinum != *w_keyboxes[i].inum)
+        if (w_arms[i].oldinum != *w_arms[i].inum)
             return true;
     }
 
     return false;
 }
 
+
+// draw the whole status bar, e.g. after starting a level or leaving the menu
+static boolean st_needrefresh;
+
 void ST_Drawer(void)
 {
-    static uint16_t st_needrefresh = 0;
-
     ST_doPaletteStuff();  // Do red-/gold-shifts from damage/items
 
-    boolean needupdate = false;
+#if !defined DISABLE_STATUS_BAR
+    // the menu can draw over the status bar
+    if (_g_menuactive)
+    {
+        st_needrefresh = true;
+        return;
+    }
 
-    if(ST_NeedUpdate())
+    if (st_needrefresh)
     {
-        needupdate = true;
-        st_needrefresh = 2; //2 screen buffers
+        ST_doRefresh();
+        st_needrefresh = false;
+        return;
     }
-    else if(st_needrefresh)
+
+    // don't load the background when there's nothing to erase
+    if (!ST_widgetsChanged())
     {
-        needupdate = true;
+        I_ClearStatusBarRects();
+        return;
     }
 
-    if(needupdate)
+    const uint8_t __far* stbar = W_TryGetLumpByNum(statusbarnum);
+    if (stbar == NULL)
     {
+        // not enough memory to restore parts of the background
         ST_doRefresh();
-
-        st_needrefresh--;
+        return;
     }
+
+    I_ClearStatusBarRects();
+    ST_updateChangedWidgets(stbar);
+    Z_ChangeTagToCache(stbar);
+#endif
 }
 
 
@@ -894,6 +1083,7 @@ static void STlib_initMultIcon(st_multicon_t* i, int16_t x, int16_t y, int16_t*
 	i->oldinum = -1;
 	i->inum    = inum;
 	i->p       = il;
+	i->rect.w  = 0;
 }
 
 
@@ -914,6 +1104,7 @@ static void STlib_initNum(st_number_t* n, int16_t x, int16_t y, int16_t* pl, int
 	n->width  = width;
 	n->num    = num;
 	n->p      = pl;
+	n->rect.w = 0;
 }
 
 
@@ -963,6 +1154,7 @@ void ST_Start(void)
     ST_Stop();
   ST_initData();
   ST_createWidgets();
+  st_needrefresh = true;
   st_stopped = false;
 }
 
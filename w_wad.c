@@ -45,6 +45,15 @@
 #include <fcntl.h>
 #include <stdint.h>
 
+#if defined _M_I86
+#include <dos.h>
+#if defined __WATCOMC__
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+#endif
+
 #include "compiler.h"
 #include "d_player.h"
 #include "doomtype.h"
@@ -74,38 +83,164 @@ typedef struct
 // GLOBALS
 //
 
-static FILE* fileWAD;
-
 static int16_t numlumps;
 
 static filelump_t __far* fileinfo;
 
 static void __far*__far* lumpcache;
 
+
+//
+// Hash index over the lump names.
+// Open addressing with linear probing,
+// every slot holds a lump number or LUMPHASH_EMPTY.
+//
+
+#define LUMPHASH_EMPTY 0xffff
+
+static uint16_t __far* lumphash;
+static uint16_t lumphashmask;
+
+
+//
+// Expanded memory lump cache.
+// Every lump read from disk into the lump cache is copied to expanded memory,
+// so after it's purged from the zone it can be copied back
+// instead of read from disk again.
+// A record is a header and the lump, and doesn't cross a page.
+// When the pages are full, the oldest page is emptied.
+//
+
+#define EMSCACHE_NONE	0xffff
+#define EMSCACHE_ALIGN	64
+
+typedef struct
+{
+	int16_t  num;
+	uint16_t size;
+} emsrecord_t;
+
+static uint16_t __far* emslumps;	// (page << 8) | (offset / EMSCACHE_ALIGN), or EMSCACHE_NONE
+static uint16_t __far* emspagefill;
+static uint16_t emspages;
+static uint16_t emscurrentpage;
+
 //
 // LUMP BASED ROUTINES.
 //
 
-#define BUFFERSIZE 512
+//
+// WAD FILE I/O
+//
+// 16-bit: DOS reads straight into far memory.
+// 32-bit: far pointers are near pointers, so fread can do the same.
+// The file routines are also used for other data files.
+// Small reads go through a sector aligned read buffer,
+// so a run of small consecutive lumps costs one DOS call.
+// The file pointer is tracked, so sequential reads don't seek.
+//
+
+#define READBUFFERSIZE	2048
+#define SECTORSIZE		512
+
+static uint8_t __far readbuffer[READBUFFERSIZE];
+static int32_t readbufferpos = -1;	// file position of readbuffer[0]
+static uint16_t readbufferlen;
+
+static int32_t filepos;				// current position of the file pointer
+
+
+static wadfile_t fileWAD;
+
+
+#if defined _M_I86
+boolean W_OpenFile(const char* filename, wadfile_t* file)
+{
+	return _dos_open(filename, O_RDONLY, file) == 0;
+}
+
+void W_CloseFile(wadfile_t file)
+{
+	_dos_close(file);
+}
+
+void W_SeekFile(wadfile_t file, int32_t offset)
+{
+	lseek(file, offset, SEEK_SET);
+}
 
-static void _ffread(void __far* ptr, uint16_t size, FILE* fp)
+uint16_t W_ReadFile(wadfile_t file, void __far* ptr, uint16_t size)
 {
-	uint8_t __far* dest = ptr;
-	uint8_t* buffer = alloca(BUFFERSIZE);
+	unsigned int bytes;
+	if (_dos_read(file, ptr, size, &bytes))
+		return 0;
+	return bytes;
+}
+#else
+boolean W_OpenFile(const char* filename, wadfile_t* file)
+{
+	*file = fopen(filename, "rb");
+	if (*file == NULL)
+		return false;
+
+	// the callers do their own buffering
+	setvbuf(*file, NULL, _IONBF, 0);
+	return true;
+}
 
-	while (size >= BUFFERSIZE)
+void W_CloseFile(wadfile_t file)
+{
+	fclose(file);
+}
+
+void W_SeekFile(wadfile_t file, int32_t offset)
+{
+	fseek(file, offset, SEEK_SET);
+}
+
+uint16_t W_ReadFile(wadfile_t file, void __far* ptr, uint16_t size)
+{
+	return fread(ptr, 1, size, file);
+}
+#endif
+
+
+static void W_Seek(int32_t offset)
+{
+	if (offset != filepos)
 	{
-		fread(buffer, BUFFERSIZE, 1, fp);
-		_fmemcpy(dest, buffer, BUFFERSIZE);
-		dest += BUFFERSIZE;
-		size -= BUFFERSIZE;
+		W_SeekFile(fileWAD, offset);
+		filepos = offset;
 	}
+}
+
 
-	if (size > 0)
+static void W_Read(int32_t offset, void __far* ptr, uint16_t size)
+{
+	// already in the read buffer?
+	if (readbufferpos <= offset && offset + size <= readbufferpos + readbufferlen)
 	{
-		fread(buffer, size, 1, fp);
-		_fmemcpy(dest, buffer, size);
+		_fmemcpy(ptr, &readbuffer[offset - readbufferpos], size);
+		return;
 	}
+
+	// don't seek back when reading sequentially
+	int32_t bufferstart = offset == filepos ? offset : offset & ~(SECTORSIZE - 1);
+
+	if (offset + size > bufferstart + READBUFFERSIZE)
+	{
+		// too big for the read buffer, read directly into the destination
+		W_Seek(offset);
+		filepos += W_ReadFile(fileWAD, ptr, size);
+		return;
+	}
+
+	W_Seek(bufferstart);
+	readbufferlen  = W_ReadFile(fileWAD, readbuffer, READBUFFERSIZE);
+	readbufferpos  = bufferstart;
+	filepos       += readbufferlen;
+
+	_fmemcpy(ptr, &readbuffer[offset - bufferstart], size);
 }
 
 typedef struct
@@ -116,27 +251,180 @@ typedef struct
   int32_t  infotableofs;
 } wadinfo_t;
 
+static uint16_t W_LumpNameHash(const char __far* name)
+{
+	uint16_t hash = 0;
+
+	for (int8_t i = 0; i < 8 && name[i]; i++)
+		hash = (hash * 31) + (uint8_t)name[i];
+
+	return hash;
+}
+
+
+//
+// W_InitLumpHash
+// The table is at least twice as big as the number of lumps.
+//
+static void W_InitLumpHash(void)
+{
+	uint16_t size = 1;
+	while (size < 2 * numlumps)
+		size <<= 1;
+
+	lumphashmask = size - 1;
+	lumphash = Z_MallocStatic(size * sizeof(*lumphash));
+	_fmemset(lumphash, 0xff, size * sizeof(*lumphash)); // LUMPHASH_EMPTY
+
+	for (int16_t i = 0; i < numlumps; i++)
+	{
+		const int64_t nameint = *(int64_t __far*)(fileinfo[i].name);
+
+		uint16_t slot = W_LumpNameHash(fileinfo[i].name) & lumphashmask;
+
+		while (lumphash[slot] != LUMPHASH_EMPTY && *(int64_t __far*)(fileinfo[lumphash[slot]].name) != nameint)
+			slot = (slot + 1) & lumphashmask;
+
+#if defined BACKWARDS
+		lumphash[slot] = i;	// the last lump with this name wins
+#else
+		if (lumphash[slot] == LUMPHASH_EMPTY)
+			lumphash[slot] = i;	// the first lump with this name wins
+#endif
+	}
+}
+
+
+static void W_InitEmsCache(void)
+{
+	emspages = Z_GetEmsCachePageCount();
+	if (!emspages)
+		return;
+
+	emslumps = Z_MallocStatic(numlumps * sizeof(*emslumps));
+	_fmemset(emslumps, 0xff, numlumps * sizeof(*emslumps)); // EMSCACHE_NONE
+
+	emspagefill = Z_MallocStatic(emspages * sizeof(*emspagefill));
+	_fmemset(emspagefill, 0, emspages * sizeof(*emspagefill));
+}
+
+
+static uint16_t W_EmsRecordSize(uint16_t size)
+{
+	return (sizeof(emsrecord_t) + size + (EMSCACHE_ALIGN - 1)) & ~(EMSCACHE_ALIGN - 1);
+}
+
+
+static void W_EmptyEmsPage(uint16_t page)
+{
+	const uint8_t __far* window = Z_MapEmsCachePage(page);
+
+	for (uint16_t offset = 0; offset < emspagefill[page]; )
+	{
+		const emsrecord_t __far* record = (const emsrecord_t __far*)&window[offset];
+
+		if (emslumps[record->num] == ((page << 8) | (offset / EMSCACHE_ALIGN)))
+			emslumps[record->num] = EMSCACHE_NONE;
+
+		offset += W_EmsRecordSize(record->size);
+	}
+
+	emspagefill[page] = 0;
+}
+
+
+static void W_StoreLumpInEms(int16_t num, const void __far* ptr)
+{
+	uint16_t size = fileinfo[num].size;
+	uint16_t recordsize = W_EmsRecordSize(size);
+
+	if (!emspages || recordsize > EMS_PAGE_SIZE)
+		return;
+
+	if (emspagefill[emscurrentpage] + recordsize > EMS_PAGE_SIZE)
+	{
+		emscurrentpage = (emscurrentpage + 1) % emspages;
+		W_EmptyEmsPage(emscurrentpage);
+	}
+
+	uint16_t offset = emspagefill[emscurrentpage];
+	uint8_t __far* window = Z_MapEmsCachePage(emscurrentpage);
+
+	emsrecord_t __far* record = (emsrecord_t __far*)&window[offset];
+	record->num  = num;
+	record->size = size;
+	_fmemcpy(record + 1, ptr, size);
+
+	emslumps[num] = (emscurrentpage << 8) | (offset / EMSCACHE_ALIGN);
+	emspagefill[emscurrentpage] += recordsize;
+}
+
+
+static boolean W_LoadLumpFromEms(int16_t num, void __far* ptr)
+{
+	if (!emspages || emslumps[num] == EMSCACHE_NONE)
+		return false;
+
+	uint16_t page   = emslumps[num] >> 8;
+	uint16_t offset = (emslumps[num] & 0xff) * EMSCACHE_ALIGN;
+
+	const uint8_t __far* window = Z_MapEmsCachePage(page);
+	const emsrecord_t __far* record = (const emsrecord_t __far*)&window[offset];
+	_fmemcpy(ptr, record + 1, record->size);
+	return true;
+}
+
+
+//
+// W_InitChecksum
+// The lump directory doesn't change after W_Init,
+// so it's only hashed once.
+//
+static uint32_t checksum;
+
+static void W_InitChecksum(void)
+{
+	const uint8_t __far* ptr = (const uint8_t __far*)fileinfo;
+	checksum = numlumps;
+
+	for (uint16_t i = 0; i < numlumps * sizeof(filelump_t); i++)
+		checksum = (checksum * 31) + ptr[i];
+}
+
+
 void W_Init(void)
 {
 	printf("\tadding doom1.wad\n");
 	printf("\tshareware version.\n");
 
-	fileWAD = fopen("DOOM1.WAD", "rb");
-	if (fileWAD == NULL)
+	if (!W_OpenFile("DOOM1.WAD", &fileWAD))
 		I_Error("Can't open DOOM1.WAD.");
 
 	wadinfo_t header;
-	fseek(fileWAD, 0, SEEK_SET);
-	fread(&header, sizeof(header), 1, fileWAD);
+	W_Read(0, &header, sizeof(header));
 
 	fileinfo = Z_MallocStatic(header.numlumps * sizeof(filelump_t));
-	fseek(fileWAD, header.infotableofs, SEEK_SET);
-	_ffread(fileinfo, sizeof(filelump_t) * header.numlumps, fileWAD);
+	W_Read(header.infotableofs, fileinfo, sizeof(filelump_t) * header.numlumps);
 
 	lumpcache = Z_MallocStatic(header.numlumps * sizeof(*lumpcache));
 	_fmemset(lumpcache, 0, header.numlumps * sizeof(*lumpcache));
 
 	numlumps = header.numlumps;
+
+	W_InitLumpHash();
+	W_InitEmsCache();
+	W_InitChecksum();
+}
+
+
+//
+// W_Checksum
+// Checksum of the lump directory,
+// changes when any lump is added, removed, moved or resized.
+//
+uint32_t W_Checksum(void)
+{
+	return checksum;
 }
 
 
@@ -165,16 +453,15 @@ int16_t PUREFUNC W_GetNumForName(const char *name)
 	int64_t nameint;
 	strncpy((char*)&nameint, name, 8);
 
-#if BACKWARDS
-	for (int16_t i = numlumps - 1; i >= 0; i--)
-#else
-	for (int16_t i = 0; i < numlumps; i++)
-#endif
+	uint16_t slot = W_LumpNameHash((const char*)&nameint) & lumphashmask;
+
+	uint16_t i;
+	while ((i = lumphash[slot]) != LUMPHASH_EMPTY)
 	{
 		if (nameint == *(int64_t __far*)(fileinfo[i].name))
-		{
 			return i;
-		}
+
+		slot = (slot + 1) & lumphashmask;
 	}
 
 	I_Error("W_GetNumForName: %.8s not found", name);
@@ -185,8 +472,7 @@ int16_t PUREFUNC W_GetNumForName(const char *name)
 void W_ReadLumpByNum(int16_t num, void __far* ptr)
 {
 	const filelump_t __far* lump = &fileinfo[num];
-	fseek(fileWAD, lump->filepos, SEEK_SET);
-	_ffread(ptr, lump->size, fileWAD);
+	W_Read(lump->filepos, ptr, lump->size);
 }
 
 
@@ -196,8 +482,7 @@ const void __far* PUREFUNC W_GetLumpByNumAutoFree(int16_t num)
 
 	void __far* ptr = Z_MallocLevel(lump->size, NULL);
 
-	fseek(fileWAD, lump->filepos, SEEK_SET);
-	_ffread(ptr, lump->size, fileWAD);
+	W_Read(lump->filepos, ptr, lump->size);
 	return ptr;
 }
 
@@ -208,8 +493,12 @@ static void __far* PUREFUNC W_GetLumpByNumWithUser(int16_t num, void __far*__far
 
 	void __far* ptr = Z_MallocStaticWithUser(lump->size, user);
 
-	fseek(fileWAD, lump->filepos, SEEK_SET);
-	_ffread(ptr, lump->size, fileWAD);
+	if (!W_LoadLumpFromEms(num, ptr))
+	{
+		W_Read(lump->filepos, ptr, lump->size);
+		W_StoreLumpInEms(num, ptr);
+	}
+
 	return ptr;
 }
 
@@ -220,9 +509,8 @@ int16_t W_GetFirstInt16(int16_t num)
 
 	int16_t firstInt16;
 
-	fseek(fileWAD, lump->filepos, SEEK_SET);
-	fread(&firstInt16, sizeof(int16_t), 1, fileWAD);
-	return firstInt16;;
+	W_Read(lump->filepos, &firstInt16, sizeof(int16_t));
+	return firstInt16;
 }
 
 
@@ -250,3 +538,61 @@ const void __far* PUREFUNC W_TryGetLumpByNum(int16_t num)
 	else
 		return NULL;
 }
+
+
+//
+// Read-ahead
+//
+// Lumps that will be needed soon can be queued,
+// and are loaded into the lump cache when there's time to spare.
+//
+
+#define READAHEADQUEUESIZE 8
+
+static int16_t readaheadqueue[READAHEADQUEUESIZE];
+static uint8_t readaheadhead;
+static uint8_t readaheadtail;
+
+
+void W_ReadAhead(int16_t num)
+{
+	if (W_IsLumpCached(num))
+		return;
+
+	for (uint8_t i = readaheadtail; i != readaheadhead; i = (i + 1) & (READAHEADQUEUESIZE - 1))
+	{
+		if (readaheadqueue[i] == num)
+			return;
+	}
+
+	uint8_t next = (readaheadhead + 1) & (READAHEADQUEUESIZE - 1);
+	if (next == readaheadtail)
+		return; // queue is full
+
+	readaheadqueue[readaheadhead] = num;
+	readaheadhead = next;
+}
+
+
+//
+// W_RunReadAhead
+// Loads one queued lump.
+// Returns false if there was nothing to do.
+//
+boolean W_RunReadAhead(void)
+{
+	if (readaheadtail == readaheadhead)
+		return false;
+
+	int16_t num = readaheadqueue[readaheadtail];
+	readaheadtail = (readaheadtail + 1) & (READAHEADQUEUESIZE - 1);
+
+	if (!W_IsLumpCached(num))
+	{
+		const void __far* ptr = W_TryGetLumpByNum(num);
+		if (ptr)
+			Z_ChangeTagToCache(ptr);
+	}
+
+	return true;
+}
@@ -39,6 +39,13 @@
 
 #include "doomtype.h"
 
+#if defined _M_I86
+typedef int   wadfile_t;
+#else
+#include <stdio.h>
+typedef FILE* wadfile_t;
+#endif
+
 
 void W_Init(void);
 
@@ -47,11 +54,20 @@ const char __far* PUREFUNC W_GetNameForNum(       int16_t num);
 uint16_t          PUREFUNC W_LumpLength(          int16_t num);
 boolean           PUREFUNC W_IsLumpCached(        int16_t num);
 int16_t                    W_GetFirstInt16(       int16_t num);
+uint32_t                   W_Checksum(void);
 const void __far* PUREFUNC W_GetLumpByNum(        int16_t num);
 const void __far* PUREFUNC W_TryGetLumpByNum(     int16_t num);
 const void __far* PUREFUNC W_GetLumpByNumAutoFree(int16_t num);
 void                       W_ReadLumpByNum(       int16_t num, void __far* ptr);
 
+boolean                    W_OpenFile(const char* filename, wadfile_t* file);
+void                       W_CloseFile(wadfile_t file);
+void                       W_SeekFile( wadfile_t file, int32_t offset);
+uint16_t                   W_ReadFile( wadfile_t file, void __far* ptr, uint16_t size);
+
+void                       W_ReadAhead(           int16_t num);
+boolean                    W_RunReadAhead(void);
+
 #define W_GetLumpByName(x)    W_GetLumpByNum(W_GetNumForName(x))
 
 #endif
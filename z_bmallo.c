@@ -45,90 +45,47 @@
 #include "z_bmallo.h"
 #include "i_system.h"
 
-typedef struct bmalpool_s {
-	struct bmalpool_s __far* nextpool;
-	size_t             blocks;
-	byte               used[];
-} bmalpool_t;
+//
+// Every pool is carved up into elements,
+// and the free elements of all pools are linked through their first bytes.
+// Allocating and freeing is popping and pushing the free list.
+// Pools are level memory, they're freed when the level ends.
+//
 
-
-__inline static void __far* getelem(bmalpool_t __far* p, size_t size, size_t n)
-{
-	return (((byte __far*)p) + sizeof(bmalpool_t) + sizeof(byte) * (p->blocks) + size * n);
-}
-
-
-__inline static PUREFUNC uint32_t linearAddress(const void __far* ptr)
-{
-	uint32_t seg = D_FP_SEG(ptr);
-	uint16_t off = D_FP_OFF(ptr);
-	return seg * 16 + off;
-}
+typedef struct bmalelem_s {
+	struct bmalelem_s __far* next;
+} bmalelem_t;
 
 
-__inline static PUREFUNC int16_t iselem(const bmalpool_t __far* pool, size_t size, const void __far* p)
+void __far* Z_BMalloc(struct block_memory_alloc_s *pzone)
 {
-	int16_t dif = linearAddress(p) - linearAddress(pool);
+	bmalelem_t __far* elem = pzone->freelist;
 
-	dif -= sizeof(bmalpool_t);
-	dif -= pool->blocks;
-	if (dif < 0)
-		return -1;
-
-	dif /= size;
-	return (((size_t)dif >= pool->blocks) ? -1 : dif);
-}
+	if (elem == NULL)
+	{
+		// Nothing available, must allocate a new pool
+		if (pzone->size < sizeof(bmalelem_t))
+			I_Error("Z_BMalloc: block size %u is too small", pzone->size);
 
+		byte __far* pool = Z_MallocLevel(pzone->size * pzone->perpool, NULL);
 
-enum { unused_block = 0, used_block = 1};
+		// Return element 0 from this pool to satisfy the request,
+		// and put the others on the free list
+		for (size_t n = pzone->perpool - 1; n > 0; n--)
+			Z_BFree(pzone, pool + pzone->size * n);
 
-
-void __far* Z_BMalloc(struct block_memory_alloc_s *pzone)
-{
-	register bmalpool_t __far*__far* pool = (bmalpool_t __far*__far*)&(pzone->firstpool);
-	while (*pool != NULL) {
-		byte __far* p = _fmemchr((*pool)->used, unused_block, (*pool)->blocks); // Scan for unused marker
-		if (p) {
-			int16_t n = p - (*pool)->used;
-			(*pool)->used[n] = used_block;
-			return getelem(*pool, pzone->size, n);
-		} else
-			pool = &((*pool)->nextpool);
+		elem = (bmalelem_t __far*)pool;
 	}
+	else
+		pzone->freelist = elem->next;
 
-	// Nothing available, must allocate a new pool
-	bmalpool_t __far* newpool;
-
-	// CPhipps: Allocate new memory, initialised to 0
-
-	*pool = newpool = Z_CallocLevel(sizeof(*newpool) + (sizeof(byte) + pzone->size) * (pzone->perpool));
-	newpool->nextpool = NULL; // NULL = (void*)0 so this is redundant
-
-	// Return element 0 from this pool to satisfy the request
-	newpool->used[0] = used_block;
-	newpool->blocks = pzone->perpool;
-	return getelem(newpool, pzone->size, 0);
+	return elem;
 }
 
 
 void Z_BFree(struct block_memory_alloc_s *pzone, void __far* p)
 {
-	register bmalpool_t __far*__far* pool = (bmalpool_t __far*__far*)&(pzone->firstpool);
-
-	while (*pool != NULL) {
-		int16_t n = iselem(*pool, pzone->size, p);
-		if (n >= 0) {
-			(*pool)->used[n] = unused_block;
-			if (_fmemchr(((*pool)->used), used_block, (*pool)->blocks) == NULL) {
-				// Block is all unused, can be freed
-				bmalpool_t __far* oldpool = *pool;
-				*pool = (*pool)->nextpool;
-				Z_Free(oldpool);
-			}
-			return;
-		} else
-			pool = &((*pool)->nextpool);
-	}
-
-	I_Error("Z_BFree: Free not in zone");
+	bmalelem_t __far* elem = p;
+	elem->next = pzone->freelist;
+	pzone->freelist = elem;
 }
@@ -34,7 +34,7 @@
  *-----------------------------------------------------------------------------*/
 
 struct block_memory_alloc_s {
-	void  __far* firstpool;
+	void  __far* freelist;
 	size_t size;
 	size_t perpool;
 };
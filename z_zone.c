@@ -48,11 +48,29 @@
 //
 // There is never any space between memblocks,
 //  and there will never be two contiguous free memblocks.
-// The rover can be left pointing at a non-empty block.
 //
 // It is of no value to free a cachable block,
 //  because it will get overwritten automatically if needed.
 //
+// When there's no free block big enough,
+//  the run of adjacent free and cachable blocks that's big enough
+//  and worth the least is purged.
+// Every block counts how often it has been released to the cache,
+//  and the counts are halved every CACHEAGINGTICS,
+//  so a block that's used often and recently is worth the most.
+// The counts are aged while looking for a run to purge.
+//
+// Free blocks are kept in size class bins, so finding a free block
+//  doesn't walk the block list.
+// Blocks up to 256 bytes have a bin per paragraph count,
+//  bigger blocks have a bin per power of two.
+// The bin links are stored in the first paragraph of the free block.
+//
+// Cachable blocks with an owner can be moved,
+//  the owner's pointer is updated.
+// When free memory is fragmented, the zone is compacted
+//  before more cachable blocks are purged.
+//
 
 #if defined INSTRUMENTED
     static int32_t running_count = 0;
@@ -65,6 +83,7 @@ typedef struct
 {
     uint32_t  size:24;		// including the header and possibly tiny fragments
     uint32_t  tag:4;		// purgelevel
+    uint32_t  uses:4;		// aged use count of a cachable block
     void __far*__far*    user;	// NULL if a free block
     segment_t next;
     segment_t prev;
@@ -80,7 +99,25 @@ typedef char assertMemblockSize[sizeof(memblock_t) <= PARAGRAPH_SIZE ? 1 : -1];
 
 
 static memblock_t __far* mainzone_sentinal;
-static segment_t   mainzone_rover_segment;
+
+#define CACHEAGINGTICS	TICRATE
+#define MAXUSES			15
+
+static int32_t lastcacheaging;
+
+
+typedef struct
+{
+    segment_t next;
+    segment_t prev;
+} freelinks_t;
+
+typedef char assertFreelinksSize[sizeof(freelinks_t) <= PARAGRAPH_SIZE ? 1 : -1];
+
+#define NUMEXACTBINS	16	// blocks of 2 up to and including 17 paragraphs
+#define NUMBINS			(NUMEXACTBINS + 13)
+
+static segment_t freebins[NUMBINS];	// 0 if a bin is empty
 
 
 static segment_t pointerToSegment(const memblock_t __far* ptr)
@@ -102,6 +139,57 @@ static memblock_t __far* segmentToPointer(segment_t seg)
 }
 
 
+static freelinks_t __far* Z_FreeLinks(segment_t seg)
+{
+	return (freelinks_t __far*)segmentToPointer(seg + 1);
+}
+
+
+static uint8_t Z_FreeBin(uint32_t size)
+{
+	uint32_t paragraphs = size / PARAGRAPH_SIZE;
+
+	if (paragraphs < NUMEXACTBINS + 2)
+		return paragraphs - 2;
+
+	uint8_t bin = NUMEXACTBINS;
+	for (paragraphs >>= 5; paragraphs && bin < NUMBINS - 1; paragraphs >>= 1)
+		bin++;
+
+	return bin;
+}
+
+
+static void Z_InsertFreeBlock(memblock_t __far* block)
+{
+	segment_t seg = pointerToSegment(block);
+	uint8_t   bin = Z_FreeBin(block->size);
+
+	freelinks_t __far* links = Z_FreeLinks(seg);
+	links->next = freebins[bin];
+	links->prev = 0;
+
+	if (freebins[bin])
+		Z_FreeLinks(freebins[bin])->prev = seg;
+
+	freebins[bin] = seg;
+}
+
+
+static void Z_RemoveFreeBlock(memblock_t __far* block)
+{
+	freelinks_t __far* links = Z_FreeLinks(pointerToSegment(block));
+
+	if (links->prev)
+		Z_FreeLinks(links->prev)->next = links->next;
+	else
+		freebins[Z_FreeBin(block->size)] = links->next;
+
+	if (links->next)
+		Z_FreeLinks(links->next)->prev = links->prev;
+}
+
+
 #define	EMS_INT			0x67
 
 #define	EMS_STATUS		0x40
@@ -112,9 +200,34 @@ static memblock_t __far* segmentToPointer(segment_t seg)
 #define	EMS_FREEPAGES	0x45
 #define	EMS_VERSION		0x46
 
+//
+// EMS
+// The zone gets all 4 pages of the page frame.
+// With -emscache and enough expanded memory, the zone gets 3 pages,
+// and the 4th physical page is a window on the pages of the lump cache.
+// Define SIMULATE_EMS as a number of pages
+// to test the lump cache with a page frame in conventional memory.
+//
+
+#define EMS_CACHE_MINPAGES	8
+#define EMS_CACHE_MAXPAGES	255
+#define EMS_WINDOW			3
+
 static uint16_t emsHandle;
+static uint16_t emsCacheHandle;
+
+static uint16_t emsZonePages;
+static uint16_t emsCachePages;
+static uint16_t emsMappedPage = 0xffff;
 
-static segment_t Z_InitExpandedMemory(void)
+#if defined _M_I86
+static segment_t emsSegment;
+#elif defined SIMULATE_EMS
+static uint8_t* emsSimulatedPages;
+static uint8_t  emsSimulatedFrame[EMS_PAGE_SIZE];
+#endif
+
+static segment_t Z_InitExpandedMemory(boolean emscache)
 {
 #if defined _M_I86
 	segment_t __far* emsInterruptVectorSegment = D_MK_FP(0, EMS_INT * 4 + 2);
@@ -146,7 +259,7 @@ static segment_t Z_InitExpandedMemory(void)
 		return 0;
 
 	// EMS page frame address
-	segment_t emsSegment = regs.w.bx;
+	emsSegment = regs.w.bx;
 
 	regs.h.ah = EMS_GETPAGES;
 	int86(EMS_INT, &regs, &regs);
@@ -155,17 +268,20 @@ static segment_t Z_InitExpandedMemory(void)
 
 	// There are at least 4 unallocated pages
 
+	uint16_t freePages = regs.w.bx;
+	emsZonePages = emscache && freePages >= 4 + EMS_CACHE_MINPAGES ? EMS_WINDOW : 4;
+
 	regs.h.ah = EMS_ALLOCPAGES;
-	regs.w.bx = 4;
+	regs.w.bx = emsZonePages;
 	int86(EMS_INT, &regs, &regs);
 	if (regs.h.ah)
 		return 0;
 
-	// 4 logical pages are allocated
+	// the logical pages of the zone are allocated
 
 	emsHandle = regs.w.dx;
 
-	for (int16_t pageNumber = 0; pageNumber < 4; pageNumber++)
+	for (int16_t pageNumber = 0; pageNumber < emsZonePages; pageNumber++)
 	{
 		regs.h.ah = EMS_MAPPAGE;
 		regs.h.al = pageNumber;	// physical page number
@@ -176,17 +292,95 @@ static segment_t Z_InitExpandedMemory(void)
 			return 0;
 	}
 	
-	// 64 kB of expanded memory is mapped
+	// the expanded memory of the zone is mapped
+
+	if (emsZonePages == EMS_WINDOW)
+	{
+		regs.h.ah = EMS_ALLOCPAGES;
+		regs.w.bx = freePages - EMS_WINDOW < EMS_CACHE_MAXPAGES ? freePages - EMS_WINDOW : EMS_CACHE_MAXPAGES;
+		int86(EMS_INT, &regs, &regs);
+		if (!regs.h.ah)
+		{
+			emsCacheHandle = regs.w.dx;
+			emsCachePages  = regs.w.bx;
+		}
+	}
 
 	return emsSegment;
 #else
+#if defined SIMULATE_EMS
+	if (emscache)
+	{
+		emsSimulatedPages = malloc((uint32_t)SIMULATE_EMS * EMS_PAGE_SIZE);
+		if (emsSimulatedPages)
+			emsCachePages = SIMULATE_EMS;
+	}
+#else
+	UNUSED(emscache);
+#endif
 	return 0;
 #endif
 }
 
 
+uint16_t Z_GetEmsCachePageCount(void)
+{
+	return emsCachePages;
+}
+
+
+//
+// Z_MapEmsCachePage
+// Maps a page of the lump cache in the window.
+// The window stays valid until another page is mapped.
+//
+uint8_t __far* Z_MapEmsCachePage(uint16_t page)
+{
+#if defined _M_I86
+	if (page != emsMappedPage)
+	{
+		union REGS regs;
+		regs.h.ah = EMS_MAPPAGE;
+		regs.h.al = EMS_WINDOW;	// physical page number
+		regs.w.bx = page;		//  logical page number
+		regs.w.dx = emsCacheHandle;
+		int86(EMS_INT, &regs, &regs);
+		if (regs.h.ah)
+			I_Error("Z_MapEmsCachePage: failed to map page %u", page);
+
+		emsMappedPage = page;
+	}
+
+	return D_MK_FP(emsSegment + EMS_WINDOW * (EMS_PAGE_SIZE / PARAGRAPH_SIZE), 0);
+#elif defined SIMULATE_EMS
+	// copy pages in and out of the frame, like mapping them
+	if (page != emsMappedPage)
+	{
+		if (emsMappedPage != 0xffff)
+			memcpy(&emsSimulatedPages[(uint32_t)emsMappedPage * EMS_PAGE_SIZE], emsSimulatedFrame, EMS_PAGE_SIZE);
+
+		memcpy(emsSimulatedFrame, &emsSimulatedPages[(uint32_t)page * EMS_PAGE_SIZE], EMS_PAGE_SIZE);
+		emsMappedPage = page;
+	}
+
+	return emsSimulatedFrame;
+#else
+	UNUSED(page);
+	return NULL;
+#endif
+}
+
+
 void Z_Shutdown(void)
 {
+	if (emsCacheHandle)
+	{
+		union REGS regs;
+		regs.h.ah = EMS_FREEPAGES;
+		regs.w.dx = emsCacheHandle;
+		int86(EMS_INT, &regs, &regs);
+	}
+
 	if (emsHandle)
 	{
 		union REGS regs;
@@ -230,7 +424,7 @@ static unsigned int _dos_allocmem(unsigned int __size, unsigned int *__seg)
 //
 // Z_Init
 //
-void Z_Init (void)
+void Z_Init (boolean emscache)
 {
 	// allocate all available conventional memory.
 	unsigned int max, segment;
@@ -252,15 +446,16 @@ void Z_Init (void)
 
 	// set the entire zone to one free block
 	memblock_t __far* block = (memblock_t __far*)mainzone;
-	mainzone_rover_segment = pointerToSegment(block);
+	segment_t block_segment = pointerToSegment(block);
 
 	mainzone_sentinal->tag  = PU_STATIC;
 	mainzone_sentinal->user = (void __far*)mainzone;
-	mainzone_sentinal->next = mainzone_rover_segment;
-	mainzone_sentinal->prev = mainzone_rover_segment;
+	mainzone_sentinal->next = block_segment;
+	mainzone_sentinal->prev = block_segment;
 
 	block->size = heapSize;
 	block->tag  = 0;
+	block->uses = 0;
 	block->user = NULL; // NULL indicates a free block.
 	block->prev = pointerToSegment(mainzone_sentinal);
 	block->next = block->prev;
@@ -268,23 +463,27 @@ void Z_Init (void)
 	block->id   = ZONEID;
 #endif
 
-	segment_t ems_segment = Z_InitExpandedMemory();
+	segment_t ems_segment = Z_InitExpandedMemory(emscache);
 	if (ems_segment)
 	{
-		segment_t romblock_segment = mainzone_rover_segment + heapSize / PARAGRAPH_SIZE - 1;
+		segment_t romblock_segment = block_segment + heapSize / PARAGRAPH_SIZE - 1;
 		memblock_t __far* romblock = segmentToPointer(romblock_segment);
 		romblock->size = (uint32_t)(ems_segment - romblock_segment) * PARAGRAPH_SIZE;
 		romblock->tag  = PU_STATIC;
+		romblock->uses = 0;
 		romblock->user = (void __far*)mainzone;
 		romblock->next = ems_segment;
-		romblock->prev = mainzone_rover_segment;
+		romblock->prev = block_segment;
 #if defined ZONEIDCHECK
 		romblock->id   = ZONEID;
 #endif
 
+		uint32_t emsSize = (uint32_t)emsZonePages * EMS_PAGE_SIZE;
+
 		memblock_t __far* emsblock = segmentToPointer(ems_segment);
-		emsblock->size = 65536;
+		emsblock->size = emsSize;
 		emsblock->tag  = 0;
+		emsblock->uses = 0;
 		emsblock->user = NULL; // NULL indicates a free block.
 		emsblock->next = block->next; // == pointerToSegment(mainzone_sentinal)
 		emsblock->prev = romblock_segment;
@@ -294,13 +493,20 @@ void Z_Init (void)
 
 		block->size -= PARAGRAPH_SIZE;
 		block->next = romblock_segment;
-		printf("Expanded:  65536 bytes\n");
-		heapSize += 65536 - PARAGRAPH_SIZE;
+		printf("Expanded: %6ld bytes\n", emsSize);
+		heapSize += emsSize - PARAGRAPH_SIZE;
+
+		Z_InsertFreeBlock(emsblock);
 	}
 	else
 		printf("Expanded:      0 bytes\n");
 
+	Z_InsertFreeBlock(block);
+
 	printf("%ld bytes allocated for zone\n", heapSize);
+
+	if (emsCachePages)
+		printf("%ld bytes of expanded memory for the lump cache\n", (uint32_t)emsCachePages * EMS_PAGE_SIZE);
 }
 
 
@@ -323,6 +529,9 @@ void Z_ChangeTagToCache(const void __far* ptr)
 		I_Error("Z_ChangeTagToCache: block has id %x instead of ZONEID", block->id);
 #endif
 	block->tag = PU_CACHE;
+
+	if (block->uses < MAXUSES)
+		block->uses++;
 }
 
 
@@ -345,6 +554,7 @@ static void Z_FreeBlock(memblock_t __far* block)
     // mark as free
     block->user = NULL;
     block->tag  = 0;
+    block->uses = 0;
 
 
 #if defined INSTRUMENTED
@@ -357,13 +567,11 @@ static void Z_FreeBlock(memblock_t __far* block)
     if (!other->user)
     {
         // merge with previous free block
+        Z_RemoveFreeBlock(other);
         other->size += block->size;
         other->next  = block->next;
         segmentToPointer(other->next)->prev = block->prev; // == pointerToSegment(other);
 
-        if (pointerToSegment(block) == mainzone_rover_segment)
-            mainzone_rover_segment = block->prev; // == pointerToSegment(other);
-
         block = other;
     }
 
@@ -371,13 +579,13 @@ static void Z_FreeBlock(memblock_t __far* block)
     if (!other->user)
     {
         // merge the next free block onto the end
+        Z_RemoveFreeBlock(other);
         block->size += other->size;
         block->next  = other->next;
         segmentToPointer(block->next)->prev = pointerToSegment(block);
-
-        if (pointerToSegment(other) == mainzone_rover_segment)
-            mainzone_rover_segment = pointerToSegment(block);
     }
+
+    Z_InsertFreeBlock(block);
 }
 
 
@@ -417,6 +625,261 @@ static uint32_t Z_GetTotalFreeMemory(void)
 }
 
 
+//
+// Z_PurgeCache
+// Finds the run of adjacent free and cachable blocks
+// that's big enough for size and has the lowest total use count,
+// in a single walk, and purges it.
+// Returns the resulting free block,
+// or NULL if there's no such run.
+//
+static memblock_t __far* Z_PurgeCache(uint32_t size)
+{
+    // age the use counts on the way
+    uint8_t shift = 0;
+    int32_t periods = (I_GetTime() - lastcacheaging) / CACHEAGINGTICS;
+    if (periods)
+    {
+        lastcacheaging += periods * CACHEAGINGTICS;
+        shift = periods > 4 ? 4 : periods;
+    }
+
+    segment_t mainzone_sentinal_segment = pointerToSegment(mainzone_sentinal);
+
+    segment_t first     = mainzone_sentinal->next;
+    uint32_t  runsize   = 0;
+    uint16_t  runuses   = 0;
+    uint16_t  runblocks = 0;
+
+    segment_t best       = 0;
+    uint16_t  bestuses   = 0;
+    uint16_t  bestblocks = 0;
+
+    for (segment_t seg = first; seg != mainzone_sentinal_segment; )
+    {
+        memblock_t __far* block = segmentToPointer(seg);
+        seg = block->next;
+
+        if (shift)
+            block->uses >>= shift;
+
+        if (block->user && block->tag < PU_PURGELEVEL)
+        {
+            // can't be purged, start a new run after it
+            first     = seg;
+            runsize   = 0;
+            runuses   = 0;
+            runblocks = 0;
+            continue;
+        }
+
+        runsize += block->size;
+        if (block->user)
+        {
+            runuses += block->uses;
+            runblocks++;
+        }
+
+        // drop the blocks at the start of the run that aren't needed
+        while (runsize - segmentToPointer(first)->size >= size)
+        {
+            memblock_t __far* dropped = segmentToPointer(first);
+            runsize -= dropped->size;
+            if (dropped->user)
+            {
+                runuses -= dropped->uses;
+                runblocks--;
+            }
+            first = dropped->next;
+        }
+
+        if (runsize >= size && (!best || runuses < bestuses))
+        {
+            best       = first;
+            bestuses   = runuses;
+            bestblocks = runblocks;
+        }
+    }
+
+    if (!best)
+        return NULL;
+
+    // the freed blocks merge into a single free block
+    memblock_t __far* base = segmentToPointer(best);
+    while (true)
+    {
+        if (base->user)
+        {
+            memblock_t __far* victim = base;
+            memblock_t __far* previous_block = segmentToPointer(victim->prev);
+            base = previous_block->user ? victim : previous_block;
+            Z_FreeBlock(victim);
+            bestblocks--;
+        }
+
+        if (!bestblocks)
+            return base;
+
+        base = segmentToPointer(base->next);
+    }
+}
+
+
+static boolean Z_IsMovable(const memblock_t __far* block)
+{
+    // far pointers with segment 0 are not user pointers
+    return block->tag >= PU_PURGELEVEL && D_FP_SEG(block->user) != 0;
+}
+
+
+static void Z_MoveBlock(segment_t dest, segment_t src, uint32_t size)
+{
+    // dest < src, so copy from low to high
+    while (size)
+    {
+        uint16_t count = size > 0x8000 ? 0x8000 : size;
+        _fmemmove(segmentToPointer(dest), segmentToPointer(src), count);
+        dest += count / PARAGRAPH_SIZE;
+        src  += count / PARAGRAPH_SIZE;
+        size -= count;
+    }
+}
+
+
+//
+// Z_CompactRun
+// Slides the movable blocks from start up to end together,
+// and returns the free block that's left at the end.
+//
+static memblock_t __far* Z_CompactRun(segment_t start, segment_t end)
+{
+    segment_t dest     = start;
+    segment_t previous = segmentToPointer(start)->prev;
+
+    // the sentinal isn't in the heap, so don't subtract end
+    uint32_t  freesize = 0;
+
+    for (segment_t seg = start; seg != end; )
+    {
+        memblock_t __far* block = segmentToPointer(seg);
+        segment_t next = block->next;
+
+        if (!block->user)
+        {
+            Z_RemoveFreeBlock(block);
+            freesize += block->size;
+        }
+        else
+        {
+            if (seg != dest)
+            {
+                Z_MoveBlock(dest, seg, block->size);
+
+                block = segmentToPointer(dest);
+                *block->user = segmentToPointer(dest + 1);
+            }
+
+            block->prev = previous;
+            segmentToPointer(previous)->next = dest;
+
+            previous = dest;
+            dest += block->size / PARAGRAPH_SIZE;
+        }
+
+        seg = next;
+    }
+
+    memblock_t __far* freeblock = segmentToPointer(dest);
+    freeblock->size = freesize;
+    freeblock->tag  = 0;
+    freeblock->uses = 0;
+    freeblock->user = NULL; // NULL indicates a free block.
+    freeblock->next = end;
+    freeblock->prev = previous;
+#if defined ZONEIDCHECK
+    freeblock->id   = ZONEID;
+#endif
+
+    segmentToPointer(previous)->next = dest;
+    segmentToPointer(end)->prev      = dest;
+
+    Z_InsertFreeBlock(freeblock);
+
+    return freeblock;
+}
+
+
+//
+// Z_Compact
+// Blocks that can't be moved split the zone into runs.
+// Compacts the first run with enough free memory for size,
+// returns NULL if there's no such run.
+//
+static memblock_t __far* Z_Compact(uint32_t size)
+{
+    segment_t mainzone_sentinal_segment = pointerToSegment(mainzone_sentinal);
+
+    segment_t start    = mainzone_sentinal->next;
+    uint32_t  freesize = 0;
+    uint16_t  freeblocks = 0;
+
+    for (segment_t seg = start; ; )
+    {
+        memblock_t __far* block = segmentToPointer(seg);
+
+        if (!block->user)
+        {
+            freesize += block->size;
+            freeblocks++;
+        }
+        else if (seg == mainzone_sentinal_segment || !Z_IsMovable(block))
+        {
+            // a single free block big enough would've been found in the bins
+            if (freesize >= size && freeblocks > 1)
+                return Z_CompactRun(start, seg);
+
+            if (seg == mainzone_sentinal_segment)
+                return NULL;
+
+            start      = block->next;
+            freesize   = 0;
+            freeblocks = 0;
+        }
+
+        seg = block->next;
+    }
+}
+
+
+//
+// Z_Reclaim
+// Compacts the zone once,
+// then purges the least valuable run of cachable blocks.
+//
+static memblock_t __far* Z_Reclaim(uint32_t size)
+{
+    memblock_t __far* base = Z_Compact(size);
+
+    if (!base)
+        base = Z_PurgeCache(size);
+
+    return base;
+}
+
+
+//
+// Z_SetPurgeHook
+// The hook is called when there's nothing left to purge,
+// and returns true if it turned static blocks into cachable ones.
+//
+static boolean (*purgehook)(void);
+
+void Z_SetPurgeHook(boolean (*hook)(void))
+{
+    purgehook = hook;
+}
+
+
 //
 // Z_TryMalloc
 // You can pass a NULL user if the tag is < PU_PURGELEVEL.
@@ -429,58 +892,45 @@ static void __far* Z_TryMalloc(uint16_t size, int8_t tag, void __far*__far* user
 {
     size = (size + (PARAGRAPH_SIZE - 1)) & ~(PARAGRAPH_SIZE - 1);
 
-    // scan through the block list,
-    // looking for the first free block
-    // of sufficient size,
-    // throwing out any purgable blocks along the way.
+    // room for the bin links once the block is freed
+    if (size == 0)
+        size = PARAGRAPH_SIZE;
 
     // account for size of block header
     size += PARAGRAPH_SIZE;
 
-    // if there is a free block behind the rover,
-    //  back up over them
-    memblock_t __far* base = segmentToPointer(mainzone_rover_segment);
-
-    memblock_t __far* previous_block = segmentToPointer(base->prev);
-    if (!previous_block->user)
-        base = previous_block;
+    // look in the bins for a free block of sufficient size.
+    // Every block in a bigger bin is big enough,
+    // only the first power of two bin can have smaller blocks.
+    memblock_t __far* base = NULL;
 
-    memblock_t __far* rover   = base;
-    segment_t   start_segment = base->prev;
-
-    do
+    for (uint8_t bin = Z_FreeBin(size); bin < NUMBINS && !base; bin++)
     {
-        if (pointerToSegment(rover) == start_segment)
+        for (segment_t seg = freebins[bin]; seg; seg = Z_FreeLinks(seg)->next)
         {
-            // scanned all the way around the list
-            return NULL;
-        }
-
-        if (rover->user)
-        {
-            if (rover->tag < PU_PURGELEVEL)
+            if (segmentToPointer(seg)->size >= size)
             {
-                // hit a block that can't be purged,
-                //  so move base past it
-                base = rover = segmentToPointer(rover->next);
-            }
-            else
-            {
-                // free the rover block (adding the size to base)
-
-                // the rover can be the base block
-                base  = segmentToPointer(base->prev);
-                Z_FreeBlock(rover);
-                base  = segmentToPointer(base->next);
-                rover = segmentToPointer(base->next);
+                base = segmentToPointer(seg);
+                break;
             }
         }
-        else
-            rover = segmentToPointer(rover->next);
+    }
+
+    if (!base)
+    {
+        base = Z_Reclaim(size);
+
+        // the blocks released by the purge hook are the last resort
+        if (!base && purgehook && purgehook())
+            base = Z_Reclaim(size);
 
-    } while (base->user || base->size < size);
+        if (!base)
+            return NULL;
+    }
     // found a block big enough
 
+    Z_RemoveFreeBlock(base);
+
     int32_t newblock_size = base->size - size;
     if (newblock_size > MINFRAGMENT)
     {
@@ -491,6 +941,7 @@ static void __far* Z_TryMalloc(uint16_t size, int8_t tag, void __far*__far* user
         memblock_t __far* newblock = segmentToPointer(newblock_segment);
         newblock->size = newblock_size;
         newblock->tag  = 0;
+        newblock->uses = 0;
         newblock->user = NULL; // NULL indicates free block.
         newblock->next = base->next;
         newblock->prev = base_segment;
@@ -501,9 +952,12 @@ static void __far* Z_TryMalloc(uint16_t size, int8_t tag, void __far*__far* user
         segmentToPointer(base->next)->prev = newblock_segment;
         base->size = size;
         base->next = newblock_segment;
+
+        Z_InsertFreeBlock(newblock);
     }
 
     base->tag  = tag;
+    base->uses = 0;
     if (user)
         base->user = user;
     else
@@ -512,9 +966,6 @@ static void __far* Z_TryMalloc(uint16_t size, int8_t tag, void __far*__far* user
     base->id  = ZONEID;
 #endif
 
-    // next allocation will start looking here
-    mainzone_rover_segment = base->next;
-
 #if defined INSTRUMENTED
     running_count += base->size;
     printf("Alloc: %ld (%ld)\n", base->size, running_count);
@@ -564,14 +1015,6 @@ void __far* Z_CallocLevel(uint16_t size)
 }
 
 
-void __far* Z_CallocLevSpec(uint16_t size)
-{
-	void __far* ptr = Z_Malloc(size, PU_LEVSPEC, NULL);
-	_fmemset(ptr, 0, size);
-	return ptr;
-}
-
-
 boolean Z_IsEnoughFreeMemory(uint16_t size)
 {
 	const uint8_t __far* ptr = Z_TryMallocStatic(size);
@@ -29,19 +29,24 @@
 #include <stddef.h>
 #include "doomtype.h"
 
-void Z_Init(void);
+void Z_Init(boolean emscache);
 void Z_Shutdown(void);
+void Z_SetPurgeHook(boolean (*hook)(void));
 boolean Z_IsEnoughFreeMemory(uint16_t size);
 void __far* Z_TryMallocStatic(uint16_t size);
 void __far* Z_MallocStatic(uint16_t size);
 void __far* Z_MallocStaticWithUser(uint16_t size, void __far*__far* user); 
 void __far* Z_MallocLevel(uint16_t size, void __far*__far* user);
 void __far* Z_CallocLevel(uint16_t size);
-void __far* Z_CallocLevSpec(uint16_t size);
 void Z_ChangeTagToStatic(const void __far* ptr);
 void Z_ChangeTagToCache(const void __far* ptr);
 void Z_Free(const void __far* ptr);
 void Z_FreeTags(void);
 void Z_CheckHeap(void);
 
+#define EMS_PAGE_SIZE 16384
+
+uint16_t Z_GetEmsCachePageCount(void);
+uint8_t __far* Z_MapEmsCachePage(uint16_t page);
+
 #endif